@@ -0,0 +1,8 @@
+# cmake -DWASM=<file> -DBUDGET=<bytes> -P CheckWasmSize.cmake
+# Prints the wasm size and fails if it is larger than BUDGET. BUDGET 0 only prints the size.
+file(SIZE ${WASM} size)
+message(STATUS "${WASM}: ${size} bytes")
+if(BUDGET GREATER 0 AND size GREATER BUDGET)
+    file(REMOVE ${WASM})
+    message(FATAL_ERROR "${WASM} is ${size} bytes, over the budget of ${BUDGET} bytes (CPTBB_WASM_BUDGET)")
+endif()
@@ -0,0 +1,46 @@
+# cmake -DTWIGGY=<twiggy> -DWASM=<file> -DSOURCE=<cptblackbill.cpp> -DREPORT=<file> -P WasmSizeReport.cmake
+# Writes the retained size of the code of each action (twiggy dominators, cptblackbill::<action>) to REPORT,
+# largest first. Actions that the compiler inlined into apply have no function of their own and are listed
+# as inlined.
+execute_process(COMMAND ${TWIGGY} dominators -f csv ${WASM} OUTPUT_VARIABLE csv RESULT_VARIABLE result)
+if(NOT result EQUAL 0)
+    message(FATAL_ERROR "twiggy failed on ${WASM}")
+endif()
+
+file(STRINGS ${SOURCE} actionlines REGEX "case \"[a-z1-5.]+\"_n.value:")
+string(REPLACE "\n" ";" csvlines "${csv}")
+set(rows "")
+foreach(line ${actionlines})
+    string(REGEX MATCH "\"([a-z1-5.]+)\"" _ ${line})
+    set(action ${CMAKE_MATCH_1})
+    set(size "")
+    foreach(csvline ${csvlines})
+        # id,name,shallow_size,shallow_size_percent,retained_size,retained_size_percent,immediate_dominator
+        if(csvline MATCHES "^[0-9]+,\"?cptblackbill::${action}\\(")
+            string(REPLACE "," ";" fields "${csvline}")
+            list(LENGTH fields n)
+            math(EXPR retained "${n} - 3")
+            list(GET fields ${retained} size)
+            break()
+        endif()
+    endforeach()
+    if(size STREQUAL "")
+        list(APPEND rows "0000000000 ${action} inlined")
+    else()
+        string(LENGTH "${size}" len)
+        math(EXPR pad "10 - ${len}")
+        string(REPEAT "0" ${pad} zeros)
+        list(APPEND rows "${zeros}${size} ${action} ${size}")
+    endif()
+endforeach()
+list(REMOVE_DUPLICATES rows)
+list(SORT rows)
+list(REVERSE rows)
+
+set(text "action retained_bytes\n")
+foreach(row ${rows})
+    string(REGEX REPLACE "^[0-9]+ " "" row ${row})
+    string(APPEND text "${row}\n")
+endforeach()
+file(WRITE ${REPORT} "${text}")
+message(STATUS "Per-action sizes written to ${REPORT}")
@@ -0,0 +1,26 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Calendar math on unix timestamps (UTC). Plain C++ without any eosiolib dependency, so it can be
+ *  tested with a host compiler.
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace calendar {
+
+    //Year and month as yyyymm. Days to civil date from http://howardhinnant.github.io/date_algorithms.html
+    inline uint64_t yyyymm(int64_t timestamp) {
+        int64_t days = (timestamp >= 0 ? timestamp : timestamp - 86399) / 86400 + 719468;
+        int64_t era = (days >= 0 ? days : days - 146096) / 146097;
+        uint64_t dayOfEra = (uint64_t)(days - era * 146097);
+        uint64_t yearOfEra = (dayOfEra - dayOfEra/1460 + dayOfEra/36524 - dayOfEra/146096) / 365;
+        uint64_t dayOfYear = dayOfEra - (365*yearOfEra + yearOfEra/4 - yearOfEra/100);
+        uint64_t mp = (5*dayOfYear + 2) / 153;
+        uint64_t month = mp < 10 ? mp + 3 : mp - 9;
+        uint64_t year = yearOfEra + era * 400 + (month <= 2 ? 1 : 0);
+        return year * 100 + month;
+    }
+}
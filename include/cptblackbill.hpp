@@ -1,6 +1,19 @@
 /**
  *  @file
  *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Build with CMake (see CMakeLists.txt). With the EOSIO CDT installed this builds the production contract
+ *  (build/production, deployed as cptblackbill) and the diagnostics contract with the test and one-off migration
+ *  actions (build/diagnostics, -DCPTBB_DIAGNOSTICS -DCPTBB_TELEMETRY, for test accounts only):
+ *      cmake -S . -B build && cmake --build build && ctest --test-dir build
+ *
+ *  The production wasm is run through wasm-opt -Oz and the build fails if it is larger than CPTBB_WASM_BUDGET
+ *  (setcode RAM is about 10 times the wasm size). cmake --build build --target sizereport lists the size per action.
+ *  The wasm is not kept in the repository. cptblackbill.abi is, and is regenerated with the target abi whenever
+ *  an action or table changes.
+ *
+ *  Scheduled cleanup: clearresult prunes results older than 30 days, both the old results in scope
+ *  cptblackbill and whole months in the monthly scopes (it calls the same code as dropmonth).
  */
 #pragma once
 
@@ -8,8 +21,41 @@
 #include <eosiolib/asset.hpp>
 #include <eosiolib/print.hpp>
 #include <eosiolib/crypto.h>
+#include <eosiolib/crypto.hpp>
+#include <eosiolib/transaction.hpp>
+#include <eosiolib/singleton.hpp>
 #include <string>
 #include <cmath>
+#include <algorithm>
+#include <cstring>
+#include <optional>
+
+#include "calendar.hpp"
+#include "maptile.hpp"
+#include "memo.hpp"
+#include "money.hpp"
+
+//Hot path counters (see cptblackbill::gettelemetry). Build with -DCPTBB_TELEMETRY to enable. Counts are
+//collected in the contract object during an action and written to the telemetry singleton once at the end.
+#ifdef CPTBB_TELEMETRY
+#define TELEMETRY_BEGIN(actionname) _tlm = actcounter{actionname, 1, 0, 0, 0, 0}
+#define TELEMETRY_ADD(field, n) _tlm.field += (n)
+#define TELEMETRY_FLUSH() flush_telemetry()
+#else
+#define TELEMETRY_BEGIN(actionname)
+#define TELEMETRY_ADD(field, n)
+#define TELEMETRY_FLUSH()
+#endif
+
+//Assert where the message is only built if the assertion fails:
+//check_lazy(cond, [&]{ return "Value " + std::to_string(value) + " is too low."; });
+template<typename F>
+inline void check_lazy(bool condition, F&& message) {
+    if(!condition){
+        std::string msg = message();
+        eosio_assert(false, msg.c_str());
+    }
+}
 
 
 /**
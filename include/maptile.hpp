@@ -0,0 +1,118 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Map tile math and coordinate parsing used by the contract. Plain C++ without any eosiolib
+ *  dependency, so the same code can be compiled and exercised with a host compiler.
+ */
+#pragma once
+
+#include <cstdint>
+#include <cmath>
+#include <string>
+
+namespace maptile {
+
+    //Zoom level of a land tile (one checkpoint per tile). See https://wiki.openstreetmap.org/wiki/Slippy_map_tilenames
+    static constexpr int landZoom = 17;
+
+    //Zoom levels with aggregated checkpoint counts for clustered map rendering
+    static constexpr int clusterZooms[] = {8, 11, 14};
+
+    inline int tilex(double longitude, int zoom) {
+        return (int)(floor((longitude + 180.0) / 360.0 * (1 << zoom)));
+    }
+
+    inline int tiley(double latitude, int zoom) {
+        double latrad = latitude * M_PI/180.0;
+        return (int)(floor((1.0 - asinh(tan(latrad)) / M_PI) / 2.0 * (1 << zoom)));
+    }
+
+    //Legacy tile id stored in treasure.tileidxy. x and y as a decimal number: x=69447 y=38120 -> 69447.38120
+    inline double tileidxy(int xTile, int yTile) {
+        double divisor = (yTile < 0) ? 100 : 10; //Same as 10^std::to_string(yTile).length()
+        for(int y = yTile / 10; y != 0; y /= 10)
+            divisor *= 10;
+        return (double)xTile + ((double)yTile / divisor);
+    }
+
+    //Interleave the bits of x and y (Morton / Z-order). All tiles inside a tile on a lower zoom level
+    //get keys in one continuous range, so a key sorted table can be range scanned by area.
+    inline uint64_t morton(uint32_t x, uint32_t y) {
+        uint64_t key = 0;
+        for(int bit = 0; bit < 32; bit++) {
+            key |= ((uint64_t)((x >> bit) & 1)) << (2 * bit);
+            key |= ((uint64_t)((y >> bit) & 1)) << (2 * bit + 1);
+        }
+        return key;
+    }
+
+    inline uint32_t mortonx(uint64_t key) {
+        uint32_t x = 0;
+        for(int bit = 0; bit < 32; bit++)
+            x |= (uint32_t)((key >> (2 * bit)) & 1) << bit;
+        return x;
+    }
+
+    inline uint32_t mortony(uint64_t key) {
+        return mortonx(key >> 1);
+    }
+
+    //Tile numbers outside the map (latitudes beyond +-85.0511) are clamped to the edge tiles
+    inline uint32_t clamptile(int tile, int zoom) {
+        if(tile < 0)
+            return 0;
+        if(tile >= (1 << zoom))
+            return (1 << zoom) - 1;
+        return (uint32_t)tile;
+    }
+
+    inline uint64_t tilekey(double latitude, double longitude, int zoom) {
+        return morton(clamptile(tilex(longitude, zoom), zoom), clamptile(tiley(latitude, zoom), zoom));
+    }
+
+    //Key of the tile on zoom level toZoom that contains the tile with key on zoom level fromZoom
+    inline uint64_t parentkey(uint64_t key, int fromZoom, int toZoom) {
+        return key >> (2 * (fromZoom - toZoom));
+    }
+
+    //Coordinate in 1/10^7 degrees (about 1 cm), exact to store and compare
+    inline int32_t fixedcoord(double degrees) {
+        return (int32_t)llround(degrees * 10000000.0);
+    }
+
+    //2022-02-10 Parse a decimal coordinate from a memo ("59.9138" or "-10.7522")
+    inline double stringtodouble(std::string str)
+    {
+        double dTmp = 0.0;
+        bool isNegative = false;
+        int iLen = str.length();
+        int iPos = str.find(".");
+        std::string strIntege = str.substr(0,iPos);
+        std::string strDecimal = str.substr(iPos + 1,iLen - iPos - 1 );
+
+        if (strIntege[0] == '-')
+            isNegative = true;
+
+        for (int i = 0; i < iPos;i++)
+        {
+            if (strIntege[i] >= '0' && strIntege[i] <= '9')
+            {
+                dTmp = dTmp * 10 + strIntege[i] - '0';
+            }
+        }
+
+        for (size_t j = 0; j < strDecimal.length(); j++)
+        {
+            if (strDecimal[j] >= '0' && strDecimal[j] <= '9')
+            {
+                dTmp += (strDecimal[j] - '0') * pow(10.0, -(double)(j + 1));
+            }
+        }
+
+        if(isNegative)
+            dTmp = dTmp * -1;
+
+        return dTmp;
+    }
+}
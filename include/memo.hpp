@@ -0,0 +1,123 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Memo text for inline transfers, written into a fixed stack buffer. No heap allocation and no
+ *  double conversion:
+ *      memo_buffer() << "Payment for selling Treasure No." << treasurepkey << "."
+ *      memo_buffer() << "Token price: USD " << memo_buffer::fixed(itemprice.amount, 4)
+ */
+#pragma once
+
+#include <eosiolib/asset.hpp>
+#include <eosiolib/name.hpp>
+#include <eosiolib/varint.hpp>
+
+class memo_buffer {
+public:
+    static constexpr uint32_t max_size = 256; //Max memo length in eosio.token
+
+    //Fixed-point number: amount with the last decimals digits after the decimal point
+    struct fixed {
+        int64_t amount;
+        uint8_t decimals;
+        fixed(int64_t a, uint8_t d) : amount(a), decimals(d) {}
+    };
+
+    memo_buffer& operator<<(const char* text) {
+        while(*text && _size < max_size)
+            _buffer[_size++] = *text++;
+        return *this;
+    }
+
+    memo_buffer& operator<<(char c) {
+        if(_size < max_size)
+            _buffer[_size++] = c;
+        return *this;
+    }
+
+    memo_buffer& operator<<(uint64_t number) {
+        char digits[20];
+        int count = 0;
+        do {
+            digits[count++] = '0' + (number % 10);
+            number /= 10;
+        } while(number > 0);
+        while(count > 0)
+            *this << digits[--count];
+        return *this;
+    }
+
+    memo_buffer& operator<<(int64_t number) {
+        if(number < 0){
+            *this << '-';
+            return *this << (uint64_t)(-(number + 1)) + 1;
+        }
+        return *this << (uint64_t)number;
+    }
+
+    memo_buffer& operator<<(uint32_t number) { return *this << (uint64_t)number; }
+    memo_buffer& operator<<(int32_t number) { return *this << (int64_t)number; }
+
+    memo_buffer& operator<<(const fixed& value) {
+        uint64_t scale = 1;
+        for(uint8_t i = 0; i < value.decimals; i++)
+            scale *= 10;
+
+        uint64_t absolute = value.amount < 0 ? (uint64_t)(-(value.amount + 1)) + 1 : (uint64_t)value.amount;
+        if(value.amount < 0)
+            *this << '-';
+        *this << absolute / scale;
+        if(value.decimals > 0){
+            *this << '.';
+            uint64_t fraction = absolute % scale;
+            for(scale /= 10; scale > 0; scale /= 10) {
+                *this << (char)('0' + fraction / scale);
+                fraction %= scale;
+            }
+        }
+        return *this;
+    }
+
+    //"12.3456 EOS"
+    memo_buffer& operator<<(const eosio::asset& quantity) {
+        *this << fixed(quantity.amount, quantity.symbol.precision()) << ' ';
+        uint64_t code = quantity.symbol.code().raw();
+        for(; code > 0; code >>= 8)
+            *this << (char)(code & 0xFF);
+        return *this;
+    }
+
+    memo_buffer& operator<<(eosio::name account) {
+        static const char charmap[] = ".12345abcdefghijklmnopqrstuvwxyz";
+        char text[13];
+        uint64_t value = account.value;
+        for(int i = 0; i < 13; i++) {
+            uint64_t c = (i == 0) ? (value & 0x0F) : (value & 0x1F);
+            text[12 - i] = charmap[c];
+            value >>= (i == 0) ? 4 : 5;
+        }
+        int length = 13;
+        while(length > 0 && text[length - 1] == '.')
+            length--;
+        for(int i = 0; i < length; i++)
+            *this << text[i];
+        return *this;
+    }
+
+    const char* data() const { return _buffer; }
+    uint32_t size() const { return _size; }
+
+    //Serialized like std::string, so it can be used as the memo in a transfer action
+    template<typename DataStream>
+    friend DataStream& operator<<(DataStream& ds, const memo_buffer& memo) {
+        ds << eosio::unsigned_int(memo._size);
+        if(memo._size > 0)
+            ds.write(memo._buffer, memo._size);
+        return ds;
+    }
+
+private:
+    char _buffer[max_size];
+    uint32_t _size = 0;
+};
@@ -0,0 +1,55 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Fee splits and price conversion in integer math. Intermediates are 128 bit, results are
+ *  checked to fit in an asset amount. Amounts are rounded down; use the remainder (amount minus
+ *  the parts) for the last receiver so nothing is lost.
+ */
+#pragma once
+
+#include <eosiolib/asset.hpp>
+
+namespace money {
+
+    static constexpr int64_t bpsPerWhole = 10000; //Basis points. 100 bps = 1 percent
+
+    //Unchecked intermediate, e.g. a USD value with 8 decimals (price * quantity). Only final amounts are
+    //range checked (see checked).
+    typedef __int128 wide;
+
+    inline wide mul(int64_t a, int64_t b) {
+        return (wide)a * b;
+    }
+
+    //value as an asset amount
+    inline int64_t checked(wide value) {
+        eosio_assert(value <= eosio::asset::max_amount && value >= -eosio::asset::max_amount, "Amount overflow in price calculation.");
+        return (int64_t)value;
+    }
+
+    //a * b / c rounded down
+    inline int64_t muldiv(int64_t a, int64_t b, int64_t c) {
+        eosio_assert(c != 0, "Division by zero in price calculation.");
+        return checked(mul(a, b) / c);
+    }
+
+    //The basisPoints part of quantity. bps(eos, 250) is 2.5 percent
+    inline eosio::asset bps(const eosio::asset& quantity, int64_t basisPoints) {
+        return eosio::asset(muldiv(quantity.amount, basisPoints, bpsPerWhole), quantity.symbol);
+    }
+
+    //Half of quantity rounded down. Give the other part quantity - half(quantity) so the odd unit is kept
+    inline eosio::asset half(const eosio::asset& quantity) {
+        return eosio::asset(quantity.amount / 2, quantity.symbol);
+    }
+
+    //usd and eosusd (USD price for 1 EOS) have 4 decimals
+    inline eosio::asset usd_to_eos(const eosio::asset& usd, const eosio::asset& eosusd) {
+        return eosio::asset(muldiv(usd.amount, 10000, eosusd.amount), eosio::symbol(eosio::symbol_code("EOS"), 4));
+    }
+
+    inline eosio::asset eos_to_usd(const eosio::asset& eos, const eosio::asset& eosusd) {
+        return eosio::asset(muldiv(eos.amount, eosusd.amount, 10000), eosio::symbol(eosio::symbol_code("USD"), 4));
+    }
+}
@@ -7,7 +7,7 @@ class [[eosio::contract]] cptblackbill : public eosio::contract {
 public:
     using contract::contract;
     
-    cptblackbill(name receiver, name code,  datastream<const char*> ds): contract(receiver, code, ds) {}
+    cptblackbill(name receiver, name code,  datastream<const char*> ds): contract(receiver, code, ds), tables(receiver) {}
     
     //Issue token
     [[eosio::action]]
@@ -67,17 +67,19 @@ public:
         //2020-05-16 If sent to cptblackbill then add quantity to sell order on exchngtokens (selling BLKBILL tokens)
         if (to == name{"cptblackbill"} && quantity.symbol == symbol(symbol_code("BLKBILL"), 4))
         {
-            exchngtokens_index exchngtokens(_self, _self.value);
+            exchngtokens_index& exchngtokens = tables.exchngtokens();
             uint64_t itemPriceInDollar = std::strtoull(memo.c_str(), NULL, 0);
+            eosio_assert(itemPriceInDollar > 0 && itemPriceInDollar <= maxSellPriceCents, "Sell price must be between 0.01 and 1000000 USD per token.");
             itemPriceInDollar = itemPriceInDollar * 100; //memo is sell amount in cent 
 
-            exchngtokens.emplace(_self, [&]( auto& row ) {
+            auto sellOrderItr = exchngtokens.emplace(_self, [&]( auto& row ) {
                 row.pkey = exchngtokens.available_primary_key();
                 row.account = from;
                 row.sell = quantity; 
                 row.itemprice = eosio::asset(itemPriceInDollar, symbol(symbol_code("USD"), 4));
                 row.timestamp = now();
             });
+            update_holdings(from, &holdings::sellorders, sellOrderItr->pkey, 1, quantity.amount);
         }
         //----------------------
     }
@@ -123,20 +125,24 @@ public:
 
         eosio_assert(eos.symbol == symbol(symbol_code("EOS"), 4), "must pay with EOS token");
         eosio_assert(eos.amount > 0, "deposit amount must be positive");
+        TELEMETRY_BEGIN("tr.other"_n);
 
         if (memo.rfind("Check Treasure No.", 0) == 0) {
             //from account pays to check a treasure value
+            TELEMETRY_BEGIN("tr.check"_n);
 
             eosio_assert(eos >= getPriceForCheckTreasureValueInEOS(), "Transfered amount is below minimum price for checking treasure value. Please refresh webpage.");
             
             uint64_t treasurepkey = std::strtoull( memo.substr(18).c_str(),NULL,0 ); //Find treasure pkey from transfer memo
             
-            treasure_index treasures(_self, _self.value);
+            treasure_index& treasures = tables.treasures();
             auto iterator = treasures.find(treasurepkey);
+            TELEMETRY_ADD(rowsread, 1);
             eosio_assert(iterator != treasures.end(), "Treasure not found.");
             eosio_assert(iterator->status == "active", "Treasure is not active.");
             
-            eosio::asset toLostDiamondValueByCptBlackBill = (eos * (90 * 100)) / 10000; //90 percent to diamond value 
+            eosio::asset toTokenHolders = money::bps(eos, 10 * 100);
+            eosio::asset toLostDiamondValueByCptBlackBill = eos - toTokenHolders; //90 percent (the rest) to diamond value 
 
             //Update diamond ownership for cptblackbill
             //The provision earned to account cptblackbill is transfered to a random treasure when the lost diamond is found
@@ -160,23 +166,26 @@ public:
             }*/
 
             //2020-02-24 Add to diamond fund
-            eosio::asset toTokenHolders = (eos * (10 * 100)) / 10000;
-            diamondfund_index diamondfund(_self, _self.value);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
             diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                 row.toTokenHolders += toTokenHolders;
                 row.diamondValue += toLostDiamondValueByCptBlackBill;
             });  
+            TELEMETRY_ADD(rowswritten, 1);
         }
         else if (memo.rfind("Unlock Treasure No.", 0) == 0) {
             //from account pays to unlock a treasure
+            TELEMETRY_BEGIN("tr.unlock"_n);
 
             //Get treasurepkey and secret code from memo
             uint64_t treasurepkey = std::strtoull( memo.substr(19).c_str(),NULL,0 ); //Find treasure pkey from transfer memo
             
-            treasure_index treasures(_self, _self.value);
+            treasure_index& treasures = tables.treasures();
             auto iterator = treasures.find(treasurepkey);
+            TELEMETRY_ADD(rowsread, 1);
             eosio_assert(iterator != treasures.end(), "Treasure not found.");
             eosio_assert(iterator->status == "active", "Treasure is not active.");
             eosio_assert(eos >= getPriceForCheckTreasureValueInEOS(), "Transfered amount is below minimum price for unlocking a treasure.");
@@ -187,121 +196,129 @@ public:
                 eosio_assert(iterator->conqueredby != from, "You are not allowed to unlock a treasure you have conquered.");
             else
                 eosio_assert(iterator->owner != from, "You are not allowed to unlock your own treasure.");
-        
         }
         else if (memo.rfind("Wrong code payment on treasure No.", 0) == 0) {
             //from account pays to unlock a treasure
+            TELEMETRY_BEGIN("tr.wrongcode"_n);
 
             //Get treasurepkey and secret code from memo
             uint64_t treasurepkey = std::strtoull( memo.substr(34).c_str(),NULL,0 ); //Find treasure pkey from transfer memo
             
-            treasure_index treasures(_self, _self.value);
+            treasure_index& treasures = tables.treasures();
             auto iterator = treasures.find(treasurepkey);
+            TELEMETRY_ADD(rowsread, 1);
             eosio_assert(iterator != treasures.end(), "Treasure not found.");
             eosio_assert(iterator->status == "active", "Treasure is not active.");
             eosio_assert(eos >= getPriceForCheckTreasureValueInEOS(), "Transfered amount is below minimum price for unlocking a treasure.");
             
             //2020-02-24 Add to diamond fund
-            eosio::asset toTokenHolders = (eos * (10 * 100)) / 10000;
-            eosio::asset toLostDiamondValueByCptBlackBill = (eos * (90 * 100)) / 10000;
-            diamondfund_index diamondfund(_self, _self.value);
+            eosio::asset toTokenHolders = money::bps(eos, 10 * 100);
+            eosio::asset toLostDiamondValueByCptBlackBill = eos - toTokenHolders; //90 percent (the rest)
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
             diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                 row.toTokenHolders += toTokenHolders;
                 row.diamondValue += toLostDiamondValueByCptBlackBill;
             });
-            
+            TELEMETRY_ADD(rowswritten, 1);
         }
         else if (memo.rfind("Activate SponsorItem No.", 0) == 0) {
+            TELEMETRY_BEGIN("tr.sponsor"_n);
             uint64_t sponsorItemPkey = std::strtoull( memo.substr(24).c_str(),NULL,0 ); //Find treasure pkey from transfer memo
 
-            sponsoritems_index sponsoritems(_self, _self.value);
+            sponsoritems_index& sponsoritems = tables.sponsoritems();
             auto iterator = sponsoritems.find(sponsorItemPkey);
+            TELEMETRY_ADD(rowsread, 1);
             eosio_assert(iterator != sponsoritems.end(), "Sponsor item not found.");
             eosio_assert(iterator->status == "pendingforadfeepayment", "Sponsor item is not pending for payment.");
             eosio_assert(eos.amount >= iterator->adFeePrice.amount, "Payment amount is less than advertising fee.");
 
             ////Take percent of the transfered EOS as provision to the lost diamond owners
-            eosio::asset toDiamondValue = (eos * (20 * 100)) / 10000;
+            eosio::asset toDiamondValue = money::bps(eos, 20 * 100);
             
             //2020-02-24 Add to diamond fund
             //2021-04-25 Add to diamond value and token holders
-            eosio::asset toTokenHolders = (eos * (10 * 100)) / 10000;
-            diamondfund_index diamondfund(_self, _self.value);
+            eosio::asset toTokenHolders = money::bps(eos, 10 * 100);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
             diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                 row.toTokenHolders += toTokenHolders; //10%
                 row.diamondValue += toDiamondValue; //20%
             });  
+            TELEMETRY_ADD(rowswritten, 1);
 
             //The other 70% is added to the treasure value 
             sponsoritems.modify(iterator, _self, [&]( auto& row ) {
                 row.treasurepkey = 0;
                 row.status = "active";
             }); 
+            TELEMETRY_ADD(rowswritten, 1);
         }
         else if (memo.rfind("AddAdventureRace:", 0) == 0) { //2020-08-11
+            TELEMETRY_BEGIN("tr.addrace"_n);
             
             //Check that amount is above minimum fee for adding a new adventure race
             eosio_assert(eos >= getPriceForCheckTreasureValueInEOS() * 2, "Transfered amount is below minimum price for creating a new adventure race.");
             
             std::string raceTitle = memo.substr(17).c_str(); //Get race title    
             
-            race_index race(_self, _self.value);
-            race.emplace(_self, [&]( auto& row ) {
+            race_index& race = tables.race();
+            auto raceItr = race.emplace(_self, [&]( auto& row ) {
                 row.pkey = race.available_primary_key();
                 row.raceowner = from;
                 row.title = raceTitle;
                 row.entryfeeusd = eosio::asset(0, symbol(symbol_code("USD"), 4));
                 row.timestamp = now();
             });
+            TELEMETRY_ADD(rowsread, 1); //available_primary_key
+            TELEMETRY_ADD(rowswritten, 1);
+            TELEMETRY_ADD(bytesemplaced, eosio::pack_size(*raceItr));
 
             //Divide fee for adding new adventure race to token holders and diamond value
-            eosio::asset toTokenHolders = (eos * (50 * 100)) / 10000; //50 percent to BLKBILL token holders
-            eosio::asset toDiamondValue = (eos * (50 * 100)) / 10000; //50 percent to diamond value
-            diamondfund_index diamondfund(_self, _self.value);
+            eosio::asset toTokenHolders = money::bps(eos, 50 * 100); //50 percent to BLKBILL token holders
+            eosio::asset toDiamondValue = eos - toTokenHolders; //50 percent (the rest) to diamond value
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
             diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                 row.toTokenHolders += toTokenHolders; //50%
                 row.diamondValue += toDiamondValue; //50%
             });
-
+            TELEMETRY_ADD(rowswritten, 1);
         }
         else if (memo.rfind("RacePayment:", 0) == 0) { //2020-08-11
+            TELEMETRY_BEGIN("tr.racepay"_n);
             
             uint64_t racePkey = std::strtoull( memo.substr(12).c_str(),NULL,0 ); //Find race pkey for payment
             asset eosusd = getEosUsdPrice();
-            double dblEosUsdPrice = eosusd.amount;
 
             if(racePkey == 10){
                 //The Lost Diamond Entry fee
-                eosio::asset toTokenHolders = (eos * (20 * 100)) / 10000; //20 percent to BLKBILL token holders
-                eosio::asset toOperationalCosts = (eos * (10 * 100)) / 10000; //10 percent to cptbbfinanc1 for operational costs
+                eosio::asset toTokenHolders = money::bps(eos, 20 * 100); //20 percent to BLKBILL token holders
+                eosio::asset toOperationalCosts = money::bps(eos, 10 * 100); //10 percent to cptbbfinanc1 for operational costs
                 //eosio::asset toDiamondValue = (eos * (20 * 100)) / 10000; //20 percent to diamond value //2024-02-16: Changed from 70% to 20%. The other 50% will be distributed to random checkpoints based on the new Distribution Of Money logic  
                 //50% to random checkpoints based on content creators work (Distribution of Money algorithm that runs every day) //2024-02-16
                 //10% to operating cost       (eos * (10 * 100)) / 10000; //10 percent to operating costs for smart contract (should be sent to cptbbfinanc1?) //2023-09-24
-                diamondfund_index diamondfund(_self, _self.value);
+                diamondfund_index& diamondfund = tables.diamondfund();
                 auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
                 auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+                TELEMETRY_ADD(rowsread, 2);
                 diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                     row.toTokenHolders += toTokenHolders; //20%
                     //row.diamondValue += toDiamondValue; //20% 2024-07-31 Removed. Level-Up payments only fund checkpoints, not the diamond.
                 });
+                TELEMETRY_ADD(rowswritten, 1);
 
-                action(
-                    permission_level{ get_self(), "active"_n },
-                    "eosio.token"_n, "transfer"_n,
-                    std::make_tuple(get_self(), "cptbbfinanc1"_n, 
-                                    toOperationalCosts, 
-                                    std::string("LevelUp-payment fee for operational costs." ))
-                ).send(); 
+                send_transfer("eosio.token"_n, "cptbbfinanc1"_n, toOperationalCosts, memo_buffer() << "LevelUp-payment fee for operational costs.");
             }
             else{
                 racepayments_index racepayments(_self, _self.value);
-                racepayments.emplace(_self, [&]( auto& row ) {
+                auto racepaymentItr = racepayments.emplace(_self, [&]( auto& row ) {
                     row.pkey = racepayments.available_primary_key();
                     row.racepkey = racePkey;
                     row.teamaccount = from; //The account who sent money
@@ -310,6 +327,9 @@ public:
                     row.eosusdprice = eosusd;
                     row.timestamp = now();
                 });
+                TELEMETRY_ADD(rowsread, 1); //available_primary_key
+                TELEMETRY_ADD(rowswritten, 1);
+                TELEMETRY_ADD(bytesemplaced, eosio::pack_size(*racepaymentItr));
             }
             //Race payment is stored in the table racepayments until the race starts. When the
             //participants solve checkpoints, the racepayment is transfered/distrubuted to race 
@@ -320,16 +340,19 @@ public:
 
         }
         else if(memo.rfind("Buy Treasure No.",0) == 0){ //2021-10-03
+            TELEMETRY_BEGIN("tr.buytreas"_n);
             
             uint64_t treasurepkey = std::strtoull( memo.substr(16).c_str(),NULL,0 ); //Find treasurePkey to buy
             
-            treasure_index treasures(_self, _self.value);
+            treasure_index& treasures = tables.treasures();
             auto treasureIterator = treasures.find(treasurepkey);
+            TELEMETRY_ADD(rowsread, 1);
             eosio_assert(treasureIterator != treasures.end(), "Treasure not found..");
             
-            treasuresale_index treasuresales(_self, _self.value);
+            treasuresale_index& treasuresales = tables.treasuresales();
             auto idxTreasureSales = treasuresales.get_index<name("treasurepkey")>();
             auto treasuresaleIterator = idxTreasureSales.find(treasurepkey); // treasuresales.find(treasurepkey);
+            TELEMETRY_ADD(rowsread, 1);
             eosio_assert(treasuresaleIterator != idxTreasureSales.end(), "Not for sale. Asking price for this treasure is not found.");
             
             eosio_assert(from != treasureIterator->owner, "You can not buy your own treasure.");
@@ -337,15 +360,15 @@ public:
             name payToTreasureOwner = treasureIterator->owner;             
             asset sendAmountInUsd = getPriceInUSD(eos);
             asset eosusd = getEosUsdPrice();
-            double dblAskingPriceInEOS = (treasuresaleIterator->askingpriceUsd.amount * 10000) / eosusd.amount;
-            uint64_t uintAskingPriceInEOS = (uint64_t)dblAskingPriceInEOS;   
-            asset askingPriceInEOS = eosio::asset(uintAskingPriceInEOS, symbol(symbol_code("EOS"), 4));       
-
-            double dblVisibleAskPriceInEos = ((double)askingPriceInEOS.amount / 10000) + 0.0001; //Add 0.0001 for rounding issues 
-            double dblVisibleAskPriceInUsd = (double)treasuresaleIterator->askingpriceUsd.amount / 10000; 
-            double dblVisibleSendAmountInUsd = ((double)sendAmountInUsd.amount / 10000) + 0.0001; //Add 0.0001 for rounding issues 
-            std::string assertErrorAmountToLowMsg = "Amount is to low. Asking price for this treasure is USD " + std::to_string(dblVisibleAskPriceInUsd) + " (" + std::to_string(dblVisibleAskPriceInEos) + " EOS). SendAmountInUsd: " + std::to_string(dblVisibleSendAmountInUsd);
-            eosio_assert(dblVisibleSendAmountInUsd >= dblVisibleAskPriceInUsd, assertErrorAmountToLowMsg.c_str());
+            asset askingPriceInEOS = money::usd_to_eos(treasuresaleIterator->askingpriceUsd, eosusd);
+
+            //Add 0.0001 to the amount sent for rounding issues 
+            check_lazy(sendAmountInUsd.amount + 1 >= treasuresaleIterator->askingpriceUsd.amount, [&]{
+                memo_buffer msg;
+                msg << "Amount is to low. Asking price for this treasure is USD " << memo_buffer::fixed(treasuresaleIterator->askingpriceUsd.amount, 4) 
+                    << " (" << memo_buffer::fixed(askingPriceInEOS.amount + 1, 4) << " EOS). SendAmountInUsd: " << memo_buffer::fixed(sendAmountInUsd.amount + 1, 4);
+                return std::string(msg.data(), msg.size());
+            });
 
             //std::string debugInfo = "DEBUGTEST: sellPkey: " + std::to_string(treasuresaleIterator->pkey) + " AskPriceInEOS: " + std::to_string(dblVisibleAskPriceInEos) + " AinUSD: " + std::to_string(dblVisibleAskPriceInUsd) + " SendAmountInUsd: " + std::to_string(dblVisibleSendAmountInUsd);
             //eosio_assert(1 == 0, debugInfo.c_str());
@@ -354,46 +377,59 @@ public:
             treasures.modify(treasureIterator, _self, [&]( auto& row ) {
                 row.owner = from;
             });
+            TELEMETRY_ADD(rowswritten, 1);
+            update_holdings(payToTreasureOwner, &holdings::checkpoints, treasurepkey, -1, 0);
+            update_holdings(from, &holdings::checkpoints, treasurepkey, 1, 0);
+
+            //The land follows the checkpoint
+            land_index& lands = tables.lands();
+            auto landItr = find_land(lands, *treasureIterator);
+            TELEMETRY_ADD(rowsread, 1);
+            if(landItr != lands.end()){
+                lands.modify(landItr, _self, [&]( auto& row ) {
+                    row.owner = from;
+                });
+                TELEMETRY_ADD(rowswritten, 1);
+            }
                     
             //Remove asking price in table treasure sales
+            update_holdings(treasuresaleIterator->account, &holdings::listings, treasurepkey, -1, -treasuresaleIterator->askingpriceUsd.amount);
             idxTreasureSales.erase(treasuresaleIterator);
+            TELEMETRY_ADD(rowswritten, 1);
 
             //Add 1% Transaction fee to the lost diamond and 1% fee to token holders
-            eosio::asset toDiamondValue = (eos * (1 * 100)) / 10000; //1 percent to diamond value
-            eosio::asset toTreasureOwnerSeller = (eos * (99 * 100)) / 10000; //98 percent to treasure seller
+            eosio::asset toDiamondValue = money::bps(eos, 1 * 100); //1 percent to diamond value
+            eosio::asset toTreasureOwnerSeller = eos - toDiamondValue; //99 percent (the rest) to treasure seller
             
-            diamondfund_index diamondfund(_self, _self.value);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
             diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                 row.diamondValue += toDiamondValue; //1%
             });
+            TELEMETRY_ADD(rowswritten, 1);
 
             //Send payment in EOS-tokens to seller 
-            action(
-                permission_level{ get_self(), "active"_n },
-                "eosio.token"_n, "transfer"_n,
-                std::make_tuple(get_self(), payToTreasureOwner, 
-                                toTreasureOwnerSeller, 
-                                std::string("Payment for selling Treasure No." + std::to_string(treasurepkey) + " (1 percent trx fee to The Lost Diamond value)" ))
-            ).send(); 
-
+            send_transfer("eosio.token"_n, payToTreasureOwner, toTreasureOwnerSeller, 
+                          memo_buffer() << "Payment for selling Treasure No." << treasurepkey << " (1 percent trx fee to The Lost Diamond value)");
         }
         else if (memo.rfind("BuyBLKBILLTokens:", 0) == 0) { //2020-05-16
+            TELEMETRY_BEGIN("tr.buytokens"_n);
             
             asset eosusd = getEosUsdPrice();
-            double dblEosUsdPrice = eosusd.amount;
             uint64_t promisedQuantityToBuy = std::strtoull( memo.substr(17).c_str(),NULL,0 ); //The amount of tokens promised to be bought for the amount sent
             uint64_t quantityReached = 0;
-            uint64_t usdBuyAmount = eosusd.amount * eos.amount;
-            uint64_t usdBuyAmountReached = 0; //Abort if this amount is above the eos-amount sent. The buyer don't get the number of tokens promised for the agreed price
+            money::wide usdBuyAmount = money::mul(eosusd.amount, eos.amount); //USD with 8 decimals
+            money::wide usdBuyAmountReached = 0; //Abort if this amount is above the eos-amount sent. The buyer don't get the number of tokens promised for the agreed price
             
-            exchngtokens_index exchngtokens(_self, _self.value);
+            exchngtokens_index& exchngtokens = tables.exchngtokens();
             auto exchngtokensItems = exchngtokens.get_index<"itemprice"_n>();
             auto iter = exchngtokensItems.lower_bound(0);
             while (iter != exchngtokensItems.end()) {
+                TELEMETRY_ADD(rowsread, 1);
                 
-                uint64_t totalUsdValueInThisSellOrder = iter->sell.amount * iter->itemprice.amount;
+                money::wide totalUsdValueInThisSellOrder = money::mul(iter->sell.amount, iter->itemprice.amount);
                 
                 if(usdBuyAmountReached >= usdBuyAmount){
                     break; //We have reached the buy amount for a promised quantity of BLKBILL tokens    
@@ -403,105 +439,78 @@ public:
                     quantityReached += iter->sell.amount;
                     usdBuyAmountReached += totalUsdValueInThisSellOrder;
                     
-                    double dblSellAmount = iter->sell.amount;
-                    double dblItemPrice = iter->itemprice.amount;
-                    double dblVisibleItemPrice = dblItemPrice / 10000;
-                    double dblNumberOfTokensSold = dblSellAmount / 10000;
-                    double dblTotalSellPriceInEos = (dblSellAmount * dblItemPrice) / dblEosUsdPrice;
-                    uint64_t totalSellPriceInEos = dblTotalSellPriceInEos;
-
-                    //std::to_string(dblNumberOfTokensSold).substr(0, std::to_string(dblNumberOfTokensSold).find(".") + 5);
-                    //std::to_string(dblNumberOfTokensSold)
+                    int64_t totalSellPriceInEos = money::muldiv(iter->sell.amount, iter->itemprice.amount, eosusd.amount);
 
                     //Send payment in EOS-tokens to seller 
-                    action(
-                        permission_level{ get_self(), "active"_n },
-                        "eosio.token"_n, "transfer"_n,
-                        std::make_tuple(get_self(), iter->account, 
-                                        eosio::asset(totalSellPriceInEos, symbol(symbol_code("EOS"), 4)), 
-                                        std::string("Payment for selling " + std::to_string(dblNumberOfTokensSold).substr(0, std::to_string(dblNumberOfTokensSold).find(".") + 5) + " BLKBILL tokens. Token price: USD " + std::to_string(dblVisibleItemPrice).substr(0, std::to_string(dblVisibleItemPrice).find(".") + 5)))
-                    ).send();
+                    send_transfer("eosio.token"_n, iter->account, eosio::asset(totalSellPriceInEos, symbol(symbol_code("EOS"), 4)), 
+                                  memo_buffer() << "Payment for selling " << memo_buffer::fixed(iter->sell.amount, 4) 
+                                                << " BLKBILL tokens. Token price: USD " << memo_buffer::fixed(iter->itemprice.amount, 4));
 
+                    update_holdings(iter->account, &holdings::sellorders, iter->pkey, -1, -iter->sell.amount);
                     iter = exchngtokensItems.erase(iter); //This sell order can be erased
+                    TELEMETRY_ADD(rowswritten, 1);
 
                 }
                 else if(totalUsdValueInThisSellOrder > (usdBuyAmount - usdBuyAmountReached))
                 {
                     //This sell order has more value than needed to cover the promised quantity
-                    double usdValueOfTokensFromThisOrderNeeded = usdBuyAmount - usdBuyAmountReached;
-                    double dblItemPriceAmount = iter->itemprice.amount;
-                    double dblNumberOfTokensFromThisOrderNeeded = usdValueOfTokensFromThisOrderNeeded / dblItemPriceAmount;
-                    uint64_t quantityNeededFromSellOrder = dblNumberOfTokensFromThisOrderNeeded; //-5
+                    money::wide usdValueOfTokensFromThisOrderNeeded = usdBuyAmount - usdBuyAmountReached;
+                    uint64_t quantityNeededFromSellOrder = money::checked(usdValueOfTokensFromThisOrderNeeded / iter->itemprice.amount);
                     uint64_t restQuantityInSellOrder = iter->sell.amount - quantityNeededFromSellOrder;
                     quantityReached += quantityNeededFromSellOrder;
 
-                    usdBuyAmountReached += (iter->itemprice.amount * quantityNeededFromSellOrder);
+                    usdBuyAmountReached += money::mul(iter->itemprice.amount, quantityNeededFromSellOrder);
                     
-                    double dblNumberOfTokensSold = dblNumberOfTokensFromThisOrderNeeded / 10000;
-                    double dblItemPrice = iter->itemprice.amount;
-                    double dblVisibleItemPrice = dblItemPrice / 10000;
-                    double dblTotalSellPriceInEos = (dblNumberOfTokensSold * dblItemPrice) / dblEosUsdPrice;
-                    uint64_t totalSellPriceInEos = dblTotalSellPriceInEos * 10000;
+                    int64_t totalSellPriceInEos = money::muldiv(quantityNeededFromSellOrder, iter->itemprice.amount, eosusd.amount);
 
+                    update_holdings(iter->account, &holdings::sellorders, iter->pkey, 0, (int64_t)restQuantityInSellOrder - iter->sell.amount);
                     exchngtokensItems.modify(iter, _self, [&]( auto& row ) {
                         row.sell = eosio::asset(restQuantityInSellOrder, symbol(symbol_code("BLKBILL"), 4));
                     });
 
                     //Send payment in EOS-tokens to seller 
-                    action(
-                        permission_level{ get_self(), "active"_n },
-                        "eosio.token"_n, "transfer"_n,
-                        std::make_tuple(get_self(), iter->account, 
-                                        eosio::asset(totalSellPriceInEos, symbol(symbol_code("EOS"), 4)), 
-                                        std::string("Payment for selling " + std::to_string(dblNumberOfTokensSold).substr(0, std::to_string(dblNumberOfTokensSold).find(".") + 5) + " BLKBILL tokens.. Token price: USD " + std::to_string(dblVisibleItemPrice).substr(0, std::to_string(dblVisibleItemPrice).find(".") + 5)))
-                    ).send();
+                    send_transfer("eosio.token"_n, iter->account, eosio::asset(totalSellPriceInEos, symbol(symbol_code("EOS"), 4)), 
+                                  memo_buffer() << "Payment for selling " << memo_buffer::fixed(quantityNeededFromSellOrder, 4) 
+                                                << " BLKBILL tokens.. Token price: USD " << memo_buffer::fixed(iter->itemprice.amount, 4));
+                    TELEMETRY_ADD(rowswritten, 1);
 
                     break; 
                 } 
             } 
 
             eosio_assert(quantityReached > 0, "No tokens available.");
-            eosio_assert(quantityReached >= (promisedQuantityToBuy * 10000), "Promised token quantity is no longer available.");
+            eosio_assert(quantityReached >= (money::wide)promisedQuantityToBuy * 10000, "Promised token quantity is no longer available.");
             eosio_assert(usdBuyAmountReached <= usdBuyAmount, "Promised token quantity for agreed price is no longer available. Please refresh and try again.");
 
             //double dblAvgPricePrToken = usdBuyAmountReached / (quantityReached * 10000);
-            uint64_t avgPricePrToken = usdBuyAmountReached / quantityReached; //dblAvgPricePrToken; //usdBuyAmountReached / (quantityReached / 10000);
-            double dblAvgPricePrToken = avgPricePrToken;
-            double dblVisibleAvgPricePrToken = dblAvgPricePrToken / 10000;
+            uint64_t avgPricePrToken = money::checked(usdBuyAmountReached / quantityReached); //dblAvgPricePrToken; //usdBuyAmountReached / (quantityReached / 10000);
 
             //Transfer BLKBILL quantity to buyer
-            action(
-                permission_level{ get_self(), "active"_n },
-                "cptblackbill"_n, "transfer"_n,
-                std::make_tuple(get_self(), 
-                                from,  
-                                eosio::asset(quantityReached, symbol(symbol_code("BLKBILL"), 4)), 
-                                std::string("Buying BLKBILL tokens on Cpt.BlackBill exchange for USD " + std::to_string(dblVisibleAvgPricePrToken).substr(0, std::to_string(dblVisibleAvgPricePrToken).find(".") + 5) + " per token."))
-            ).send();
-
-            exchngbuylog_index exchngbuylog(_self, _self.value);
-            exchngbuylog.emplace(_self, [&]( auto& row ) {
-                row.pkey = exchngbuylog.available_primary_key();
-                row.toaccount = from; //The account who sent money receives the tokens
-                row.tokens = eosio::asset(quantityReached, symbol(symbol_code("BLKBILL"), 4));
-                row.itemprice = eosio::asset(avgPricePrToken, symbol(symbol_code("USD"), 4));
-                row.eosprice = getPriceInUSD(eosio::asset(10000, symbol(symbol_code("EOS"), 4))); //Usd price for 1 EOS
-                row.timestamp = now();
-            });
+            send_transfer("cptblackbill"_n, from, eosio::asset(quantityReached, symbol(symbol_code("BLKBILL"), 4)), 
+                          memo_buffer() << "Buying BLKBILL tokens on Cpt.BlackBill exchange for USD " << memo_buffer::fixed(avgPricePrToken, 4) << " per token.");
+
+            exchngbuylog fill{};
+            fill.toaccount = from; //The account who sent money receives the tokens
+            fill.tokens = eosio::asset(quantityReached, symbol(symbol_code("BLKBILL"), 4));
+            fill.itemprice = eosio::asset(avgPricePrToken, symbol(symbol_code("USD"), 4));
+            fill.eosprice = getPriceInUSD(eosio::asset(10000, symbol(symbol_code("EOS"), 4))); //Usd price for 1 EOS
+            fill.timestamp = now();
+            add_history(tables.exchngbuylog(), &historyseq::nextbuylog, "logfill"_n, fill);
             
         }
         else if (memo.rfind("RandomChestFunding:", 0) == 0) { //2022-02-10
+            TELEMETRY_BEGIN("tr.rndchest"_n);
             eosio_assert(eos >= getPriceForCheckTreasureValueInEOS(), "Transfered amount is below minimum.");
 
             //The fund will be added to the cptblackbill account and redistributed by a 
-            //scheduled task that will fill random checkpoints
+            //scheduled task that will fill random checkpoints (execchestbatch, or exechestfnd for country funding)
             //Valid parameter examples: 
             //RandomChestFunding: (blank)           Will distribute the fund to a random checkpoint
             //RandomChestFunding:{ChestAmount:2}    Will distribute $2 to as many random checkpoints the total amount allow
             //RandomChestFunding:{Spain:50,USA:50}  Will distribute fund 50% to a random checkpoint in Spain and 50% to a random checkpoint in USA 
 
-            rndchestfnd_index rndchestfnd(_self, _self.value);
-            rndchestfnd.emplace(_self, [&]( auto& row ) {
+            rndchestfnd_index& rndchestfnd = tables.rndchestfnd();
+            auto rndchestfndItr = rndchestfnd.emplace(_self, [&]( auto& row ) {
                 row.pkey = rndchestfnd.available_primary_key();
                 row.from = from;
                 row.amount = eos;
@@ -509,9 +518,12 @@ public:
                 row.executed = false;
                 row.timestamp = now();
             });
+            TELEMETRY_ADD(rowsread, 1); //available_primary_key
+            TELEMETRY_ADD(rowswritten, 1);
+            TELEMETRY_ADD(bytesemplaced, eosio::pack_size(*rndchestfndItr));
         }
         else if (memo.rfind("MintCheckpoint:", 0) == 0) { //2022-02-10
-            std::string assertMsg = "";
+            TELEMETRY_BEGIN("tr.mint"_n);
             eosio_assert(eos >= getPriceForCheckTreasureValueInEOS(), "Transfered amount is below minimum.");
             
             //accounts accountstable(eosio::name("cptblackbill"), from.value);
@@ -534,8 +546,8 @@ public:
             std::string title =                memo.substr(n1 + 1, n2 - (n1 + 1));
             std::string imageurl =             memo.substr(n2 + 1, n3 - (n2 + 1));
             std::string videourl =             memo.substr(n3 + 1, n4 - (n3 + 1));
-            double latitude = stringtodouble(  memo.substr(n4 + 1, n5 - (n4 + 1))); 
-            double longitude = stringtodouble( memo.substr(n5 + 1, n6 - (n5 + 1)));
+            double latitude = maptile::stringtodouble(  memo.substr(n4 + 1, n5 - (n4 + 1))); 
+            double longitude = maptile::stringtodouble( memo.substr(n5 + 1, n6 - (n5 + 1)));
             std::string description =          memo.substr(n6 + 1, n7 - (n6 + 1));
             
             eosio_assert(title.length() <= 55, "Max length of title is 55 characters.");
@@ -552,53 +564,59 @@ public:
             }
             
             eosio_assert(locationIsValid, "Location (latitude and/ord longitude) is not valid.");
-            int tileZoomLevel = 17;
-            int xTile = (int)(floor((longitude + 180.0) / 360.0 * (1 << tileZoomLevel)));
-            double latrad = latitude * M_PI/180.0;
-	        int yTile = (int)(floor((1.0 - asinh(tan(latrad)) / M_PI) / 2.0 * (1 << tileZoomLevel)));
-            
-            std::string s1 = std::to_string(xTile) + "." + std::to_string(yTile);
-            double tilexy = (double)xTile + ( (double)yTile / pow(10, std::to_string(yTile).length()) ); 
+            int tileZoomLevel = maptile::landZoom;
+            int xTile = maptile::tilex(longitude, tileZoomLevel);
+            int yTile = maptile::tiley(latitude, tileZoomLevel);
+            double tilexy = maptile::tileidxy(xTile, yTile);
 
             //Check if map tile is available (not owned by others)
-            //std::string testRet = "";
+            //Land ownership is found with one lookup in the land table. The tileidxy probe below is
+            //only needed until migration migrLand has registered land for all checkpoints minted before the land table existed.
+            uint64_t tileKey = maptile::tilekey(latitude, longitude, tileZoomLevel);
             bool mapTileIsTaken = false;
             eosio::name landOwner;
-            treasure_index existingTreasures(_self, _self.value);
-            auto idx = existingTreasures.get_index<name("tileidxy"_n)>();  
-            auto itrTiles = idx.lower_bound(tilexy); 
-            int itrTileCounter = 0;
-            
-            while (itrTiles != idx.end())
-            {
-                int existingTileX = (int)(floor((itrTiles->longitude + 180.0) / 360.0 * (1 << tileZoomLevel)));
-                double existingLatrad = itrTiles->latitude * M_PI/180.0;
-	            int existingTileY = (int)(floor((1.0 - asinh(tan(existingLatrad)) / M_PI) / 2.0 * (1 << tileZoomLevel)));
-                if(existingTileX == xTile && existingTileY == yTile){
-                    mapTileIsTaken = true;
-                    landOwner = name{itrTiles->owner};
-                    break;   
-                }
+            land_index& lands = tables.lands();
+            auto landItr = lands.find(tileKey);
+            TELEMETRY_ADD(rowsread, 1);
+            if(landItr != lands.end()){
+                mapTileIsTaken = true;
+                landOwner = landItr->owner;
+            }
+            else if(!migration_completed(migrLand)){
+                treasure_index& existingTreasures = tables.treasures();
+                auto idx = existingTreasures.get_index<name("tileidxy"_n)>();  
+                auto itrTiles = idx.lower_bound(tilexy); 
+                int itrTileCounter = 0;
+                
+                while (itrTiles != idx.end())
+                {
+                    int existingTileX = maptile::tilex(itrTiles->longitude, tileZoomLevel);
+                    int existingTileY = maptile::tiley(itrTiles->latitude, tileZoomLevel);
+                    if(existingTileX == xTile && existingTileY == yTile){
+                        mapTileIsTaken = true;
+                        landOwner = name{itrTiles->owner};
+                        break;   
+                    }
 
-                itrTiles++;
-                itrTileCounter++;
+                    itrTiles++;
+                    itrTileCounter++;
+                    TELEMETRY_ADD(rowsread, 1);
 
-                if(itrTileCounter > 10) //Lower bound loop will normally find existing tile (if any) at first item. 
-                    break;
+                    if(itrTileCounter > 10) //Lower bound loop will normally find existing tile (if any) at first item. 
+                        break;
+                }
             }
 
-            if(mapTileIsTaken == true && landOwner == from){
-                assertMsg = "You already own this land and have a checkpoint on it. (Map Tile: https://tile.openstreetmap.org/17/" + std::to_string(xTile) + "/" + std::to_string(yTile) + ".png)";
-                eosio_assert(1 == 2, assertMsg.c_str());
-            }
-            else if(mapTileIsTaken == true && landOwner != from){
-                assertMsg = "This land (map tile https://tile.openstreetmap.org/17/" + std::to_string(xTile) + "/" + std::to_string(yTile) + ".png) is owned by account " + name{landOwner}.to_string() + ". You are not allowed to create new checkpoints here.";
-                eosio_assert(1 == 2, assertMsg.c_str());    
-            }
+            check_lazy(!(mapTileIsTaken == true && landOwner == from), [&]{
+                return "You already own this land and have a checkpoint on it. (Map Tile: https://tile.openstreetmap.org/17/" + std::to_string(xTile) + "/" + std::to_string(yTile) + ".png)";
+            });
+            check_lazy(!(mapTileIsTaken == true && landOwner != from), [&]{
+                return "This land (map tile https://tile.openstreetmap.org/17/" + std::to_string(xTile) + "/" + std::to_string(yTile) + ".png) is owned by account " + name{landOwner}.to_string() + ". You are not allowed to create new checkpoints here.";
+            });
 
-            treasure_index treasures(_self, _self.value);
+            treasure_index& treasures = tables.treasures();
             
-            treasures.emplace(_self, [&]( auto& row ) {
+            auto treasureItr = treasures.emplace(_self, [&]( auto& row ) {
                 row.pkey = treasures.available_primary_key();
                 row.owner = from;
                 row.title = title;
@@ -608,46 +626,67 @@ public:
                 row.latitude = latitude;
                 row.longitude = longitude;
                 row.tileidxy = tilexy;
+                row.latitudee7 = maptile::fixedcoord(latitude);
+                row.longitudee7 = maptile::fixedcoord(longitude);
                 row.rankingpoint = 5;
                 row.expirationdate = now() + 94608000; //Treasure expires after three years if not found
                 row.status = "active";
                 row.jsondata = mintId;
                 row.timestamp = now();
             });
+            TELEMETRY_ADD(rowsread, 1); //available_primary_key
+            TELEMETRY_ADD(rowswritten, 1);
+            TELEMETRY_ADD(bytesemplaced, eosio::pack_size(*treasureItr));
+
+            //Claim the land
+            lands.emplace(_self, [&]( auto& row ) {
+                row.tilekey = tileKey;
+                row.owner = from;
+                row.treasurepkey = treasureItr->pkey;
+            });
+            TELEMETRY_ADD(rowswritten, 1);
+            TELEMETRY_ADD(bytesemplaced, eosio::pack_size(land{}));
+            reindex_treasure(treasureItr->pkey, treasurestate{}, treasurestate{true, latitude, longitude, treasureItr->rankingpoint});
+            update_holdings(from, &holdings::checkpoints, treasureItr->pkey, 1, 0);
 
             //Add payment to diamond fund
-            diamondfund_index diamondfund(_self, _self.value);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
             diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                 row.diamondValue += eos; //100%
             });  
-        
+            TELEMETRY_ADD(rowswritten, 1);
         }
         else if (memo.rfind("AddToDiamond:", 0) == 0) { //2024-06-01
-            std::string assertMsg = "";
+            TELEMETRY_BEGIN("tr.adddiamnd"_n);
             eosio_assert(eos >= getPriceForCheckTreasureValueInEOS(), "Transfered amount is below minimum.");
             
-            diamondfund_index diamondfund(_self, _self.value);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
 
             if(diamondFundIterator->foundTimestamp == 0){
                 //present diamond has not been found. Add value to existing diamond
                 diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                     row.diamondValue += eos; //100%
                 });  
+                TELEMETRY_ADD(rowswritten, 1);
             }
             else{
                 //present diamond has been found. Create new diamond and add transferred value to new diamond
                 //diamondfund_index diamondfund(_code, _code.value);
-                diamondfund.emplace(_self, [&]( auto& row ) { 
+                auto newDiamondItr = diamondfund.emplace(_self, [&]( auto& row ) { 
                     row.pkey = diamondfund.available_primary_key();
                     //row.toDiamondOwners = eosio::asset(0, symbol(symbol_code("EOS"), 4));
                     row.toTokenHolders = eosio::asset(0, symbol(symbol_code("EOS"), 4));
                     row.diamondValue = eos; 
                     row.foundTimestamp = 0;
                 });
+                TELEMETRY_ADD(rowswritten, 1);
+                TELEMETRY_ADD(bytesemplaced, eosio::pack_size(*newDiamondItr));
             }
         }
         else{
@@ -735,6 +774,8 @@ public:
                 //eosio_assert(1 == 0 , "Invalid transfer to cpt.blackbill smart contract. Minimum amount is $1.");
             //}
         }
+
+        TELEMETRY_FLUSH();
     }
     //=====================================================================
 
@@ -746,41 +787,6 @@ public:
         return true;
     }
 
-    //2022-02-10
-    double stringtodouble(std::string str)
-    {
-        double dTmp = 0.0;
-        bool isNegative = false;
-        int iLen = str.length();
-        int iPos = str.find(".");
-        std::string strIntege = str.substr(0,iPos);
-        std::string strDecimal = str.substr(iPos + 1,iLen - iPos - 1 );
-        
-        if (strIntege[0] == '-')
-            isNegative = true;
-
-        for (int i = 0; i < iPos;i++)
-        {
-            if (strIntege[i] >= '0' && strIntege[i] <= '9')
-            {
-                dTmp = dTmp * 10 + strIntege[i] - '0';
-            }
-        }
-        
-        for (int j = 0; j < strDecimal.length(); j++)
-        {
-            if (strDecimal[j] >= '0' && strDecimal[j] <= '9')
-            {
-                dTmp += (strDecimal[j] - '0') * pow(10.0,(0 - j - 1));
-            }
-        }
-
-        if(isNegative)
-            dTmp = dTmp * -1;
-
-        return dTmp;
-    } 
-
     /* 2022-07-04 Add treasure is replaced with MintCheckpoint in transfer function 
     [[eosio::action]]
     void addtreasure(eosio::name owner, std::string title, std::string imageurl, 
@@ -823,14 +829,14 @@ public:
     {
         require_auth(treasureowner);
         
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(treasurepkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
         eosio_assert(treasureowner == iterator->owner, "You are not the owner of this treasure.");
         eosio_assert(askingpriceUsd.symbol == symbol(symbol_code("USD"), 4), "Asking price must be in USD.");
         eosio_assert(askingpriceUsd.amount >= 10000, "Asking price can not be less than one dollar.");
         
-        treasuresale_index treasuresales(_code, _code.value);
+        treasuresale_index& treasuresales = tables.treasuresales();
         auto idxTreasureSales = treasuresales.get_index<name("treasurepkey")>();
         auto treasuresaleIterator = idxTreasureSales.find(treasurepkey); 
         if(treasuresaleIterator == idxTreasureSales.end()){
@@ -843,8 +849,10 @@ public:
                 row.expirationdate = now() + 31536000; //Asking price expires after one year
                 row.timestamp = now();
             });
+            update_holdings(treasureowner, &holdings::listings, treasurepkey, 1, askingpriceUsd.amount);
         }
         else{
+            update_holdings(treasuresaleIterator->account, &holdings::listings, treasurepkey, 0, askingpriceUsd.amount - treasuresaleIterator->askingpriceUsd.amount);
             idxTreasureSales.modify(treasuresaleIterator, _self, [&]( auto& row ) {
                 row.askingpriceUsd = askingpriceUsd;
                 row.memo = memo;
@@ -858,20 +866,22 @@ public:
     {
         require_auth(treasureowner);
 
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto treasureIterator = treasures.find(treasurepkey);
         eosio_assert(treasureIterator != treasures.end(), "Treasure not found.");
         eosio_assert(treasureowner == treasureIterator->owner, "You are not the owner of this treasure.");
         
-        treasuresale_index treasuresales(_code, _code.value);
+        treasuresale_index& treasuresales = tables.treasuresales();
         auto idxTreasureSales = treasuresales.get_index<name("treasurepkey")>();
         //auto treasuresaleIterator = idxTreasureSales.find(treasurepkey); // treasuresales.find(treasurepkey);
         auto treasuresaleIterator = idxTreasureSales.find(treasurepkey); // lower_bound(treasurepkey) or treasuresales.find(treasurepkey);
         
         eosio_assert(treasuresaleIterator != idxTreasureSales.end(), "No active sell price found. Tresure is not for sale.");
         while(treasuresaleIterator != idxTreasureSales.end()) {
-            if(treasuresaleIterator->account == treasureowner && treasuresaleIterator->treasurepkey == treasurepkey)
+            if(treasuresaleIterator->account == treasureowner && treasuresaleIterator->treasurepkey == treasurepkey){
+                update_holdings(treasureowner, &holdings::listings, treasurepkey, -1, -treasuresaleIterator->askingpriceUsd.amount);
                 treasuresaleIterator = idxTreasureSales.erase(treasuresaleIterator);
+            }
             else
                 treasuresaleIterator++;    
         }   
@@ -901,17 +911,22 @@ public:
     [[eosio::action]]
     void delteammbr() {
         require_auth("cptblackbill"_n);
+        TELEMETRY_BEGIN("delteammbr"_n);
         
         uint64_t counter = 0;
         teambearland_index teambearland(_self, _self.value);
         auto itr = teambearland.begin();
         while(itr != teambearland.end()) {
             itr = teambearland.erase(itr);
+            TELEMETRY_ADD(rowsread, 1);
+            TELEMETRY_ADD(rowswritten, 1);
 
             counter++;
             if(counter >= 500) //Prevent exceed cpu usage
                 break;
         } 
+
+        TELEMETRY_FLUSH();
     }
 
     [[eosio::action]]
@@ -934,10 +949,17 @@ public:
         }
         
         eosio_assert(locationIsValid, "Location (latitude and/ord longitude) is not valid.");
+
+        //The checkpoint claims its land (map tile) the same way as a minted checkpoint
+        int xTile = maptile::tilex(longitude, maptile::landZoom);
+        int yTile = maptile::tiley(latitude, maptile::landZoom);
+        uint64_t tileKey = maptile::tilekey(latitude, longitude, maptile::landZoom);
+        land_index& lands = tables.lands();
+        eosio_assert(lands.find(tileKey) == lands.end(), "This land (map tile) is owned by another checkpoint.");
         
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         
-        treasures.emplace(_self, [&]( auto& row ) {
+        auto treasureItr = treasures.emplace(_self, [&]( auto& row ) {
             row.pkey = pkey;
             row.owner = owner;
             row.title = title;
@@ -947,11 +969,22 @@ public:
             row.videourl = videourl;
             row.latitude = latitude;
             row.longitude = longitude;
+            row.tileidxy = maptile::tileidxy(xTile, yTile);
+            row.latitudee7 = maptile::fixedcoord(latitude);
+            row.longitudee7 = maptile::fixedcoord(longitude);
             row.rankingpoint = rankingpoint;
             row.expirationdate = expirationdate; 
             row.status = status;
             row.timestamp = timestamp;
         });
+
+        lands.emplace(_self, [&]( auto& row ) {
+            row.tilekey = tileKey;
+            row.owner = owner;
+            row.treasurepkey = pkey;
+        });
+        reindex_treasure(pkey, treasurestate{}, get_treasurestate(*treasureItr));
+        update_holdings(owner, &holdings::checkpoints, pkey, 1, 0);
     }
 
     [[eosio::action]]
@@ -959,7 +992,7 @@ public:
                      std::string videourl) 
     {
         require_auth( user );
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
         eosio_assert(user == iterator->owner || user == iterator->conqueredby || user == "cptblackbill"_n, "You don't have access to modify this treasure.");
@@ -989,7 +1022,7 @@ public:
 
         //Modify diamond value to correct amount in EOS
         //Used by cptblackbill account if diamond value exceeds actual amount on account or if something is wrong.
-        diamondfund_index diamondfund(_self, _self.value);
+        diamondfund_index& diamondfund = tables.diamondfund();
         auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
         auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
         diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
@@ -1001,7 +1034,7 @@ public:
     void modtreasimg(name user, uint64_t pkey, std::string imageurl) 
     {
         require_auth( user );
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
         //eosio_assert(user == iterator->owner || user == "cptblackbill"_n, "You don't have access to modify this treasure.");
@@ -1020,7 +1053,7 @@ public:
     void modgps(name user, uint64_t pkey, double latitude, double longitude) 
     {
         require_auth( user );
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
         eosio_assert(user == iterator->owner || user == iterator->conqueredby || user == "cptblackbill"_n, "You don't have access to modify this treasure.");
@@ -1037,25 +1070,46 @@ public:
         eosio_assert(locationIsValid, "Location (latitude and/ord longitude) is not valid.");
 
         //Get map tilexy id
-        int tileZoomLevel = 17;
-        int xTile = (int)(floor((longitude + 180.0) / 360.0 * (1 << tileZoomLevel)));
-        double latrad = latitude * M_PI/180.0;
-        int yTile = (int)(floor((1.0 - asinh(tan(latrad)) / M_PI) / 2.0 * (1 << tileZoomLevel)));
-        std::string s1 = std::to_string(xTile) + "." + std::to_string(yTile);
-        double tilexy = (double)xTile + ( (double)yTile / pow(10, std::to_string(yTile).length()) ); // (std::to_string(yTile).length() * 10);
+        int xTile = maptile::tilex(longitude, maptile::landZoom);
+        int yTile = maptile::tiley(latitude, maptile::landZoom);
+        double tilexy = maptile::tileidxy(xTile, yTile);
+
+        //Move the land claim if the checkpoint is moved to another map tile
+        treasurestate before = get_treasurestate(*iterator);
+        uint64_t tileKey = maptile::tilekey(latitude, longitude, maptile::landZoom);
+        land_index& lands = tables.lands();
+        auto oldLandItr = find_land(lands, *iterator);
+        if(oldLandItr == lands.end() || oldLandItr->tilekey != tileKey){
+            auto newLandItr = lands.find(tileKey);
+            eosio_assert(newLandItr == lands.end() || newLandItr->treasurepkey == pkey, "This land (map tile) is owned by another checkpoint.");
+
+            if(oldLandItr != lands.end())
+                lands.erase(oldLandItr);
+
+            if(newLandItr == lands.end()){
+                lands.emplace(_self, [&]( auto& row ) {
+                    row.tilekey = tileKey;
+                    row.owner = iterator->owner;
+                    row.treasurepkey = pkey;
+                });
+            }
+        }
 
         treasures.modify(iterator, user, [&]( auto& row ) {
             row.latitude = latitude;
             row.longitude = longitude;
             row.tileidxy = tilexy;
+            row.latitudee7 = maptile::fixedcoord(latitude);
+            row.longitudee7 = maptile::fixedcoord(longitude);
         });
+        reindex_treasure(pkey, before, get_treasurestate(*iterator));
     }
 
     [[eosio::action]]
     void modtreasjson(name user, uint64_t pkey, std::string jsondata) 
     {
         require_auth( user );
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
         eosio_assert(user == "cptblackbill"_n, "You don't have access to modify this treasure.");
@@ -1069,7 +1123,7 @@ public:
     void modsecretcode(name user, uint64_t pkey, std::string encryptedSecretCode) 
     {
         require_auth( user );
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
         eosio_assert(user == "cptblackbill"_n, "You don't have access to modify secret code on this treasure.");
@@ -1090,7 +1144,7 @@ public:
     {
         require_auth("cptblackbill"_n); //Only allowed by cptblackbill contract
 
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
         
@@ -1111,12 +1165,14 @@ public:
         //} 
         //numberOfUniqueUserUnlocks = uniqueUsersSet.size();
         
+        treasurestate before = get_treasurestate(*iterator);
         treasures.modify(iterator, _self, [&]( auto& row ) {
             row.status = "active";
             row.secretcode = encryptedSecretCode;
             //row.rankingpoint = numberOfUniqueUserUnlocks; 2022-12-29 Removed
             row.expirationdate = now() + 94608000; //Treasure ownership renewed for three years
         });
+        reindex_treasure(pkey, before, get_treasurestate(*iterator));
     }
 
     [[eosio::action]]
@@ -1124,54 +1180,10 @@ public:
     {
         require_auth("cptblackbill"_n); //Only allowed by cptblackbill contract
 
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
-
-        if(cTypeId == 0 ){ //Everything OK - Checkpoint NFT Challenge is active and in normal operation
-            treasures.modify(iterator, _self, [&]( auto& row ) {
-                row.status = "active";
-                row.ctypeid = cTypeId;
-                row.banditalarms = 0;
-                row.expirationdate = now() + 94608000; //Treasure ownership renewed for three years
-            });
-        }
-        else if(cTypeId >= 1 && cTypeId < 10){
-            treasures.modify(iterator, _self, [&]( auto& row ) {
-                row.status = "active";
-                row.ctypeid = cTypeId;
-                row.expirationdate = now() + 94608000; //Treasure ownership renewed for three years
-            });
-        }
-        else if(cTypeId == 90){ //
-            //Checkpoint has Bandit Alarms that has not been fixed within 30 days. Set as inactive and expired.
-            treasures.modify(iterator, _self, [&]( auto& row ) {
-                row.status = "inactive";
-                row.ctypeid = cTypeId;
-                row.banditalarms = row.banditalarms + 1;
-                row.expirationdate = now(); //Expires now. Owner has already had 30 days to fix it.
-            });
-        }
-        else if(cTypeId == 91){ //
-            //91: Same secret code has been used more than ten times. 
-            //Set checkpoint as inactive and to expire after 30 days
-            treasures.modify(iterator, _self, [&]( auto& row ) {
-                row.status = "inactive";
-                row.ctypeid = cTypeId;
-                row.expirationdate = now() + 2592000; //Expires after 30 days if secret code is not replaced
-            });
-        }
-        else if(cTypeId >= 92 && cTypeId < 100){ //Checkpoint NFT Challenge is inactive for other reasons and not in normal operation
-            treasures.modify(iterator, _self, [&]( auto& row ) {
-                row.status = "inactive";
-                row.ctypeid = cTypeId;
-            });
-        }
-        else{
-            treasures.modify(iterator, _self, [&]( auto& row ) {
-                row.ctypeid = cTypeId;
-            });
-        }
+        set_ctypeid(treasures, iterator, cTypeId);
     }
     
     //2022-12-29 updranking. Ranking points are calculated by several criterias in a front end view.
@@ -1180,12 +1192,42 @@ public:
     {
         require_auth("cptblackbill"_n); //Only allowed by cptblackbill contract
 
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
-        
-        treasures.modify(iterator, _self, [&]( auto& row ) {
-            row.rankingpoint = rankingPoints;
+        set_ranking(treasures, iterator, rankingPoints);
+    }
+
+    //Batch versions of updranking, modctypeid and modexpdate. Each update is a pair of pkey and value.
+    //Max number of updates per action is the setting maxbatch (default 200).
+    [[eosio::action]]
+    void updrankings(std::vector<std::pair<uint64_t, uint64_t>> updates) 
+    {
+        require_auth("cptblackbill"_n); //Only allowed by cptblackbill contract
+        treasure_index& treasures = tables.treasures();
+        for_each_treasure(treasures, updates, [&](treasure_index::const_iterator iterator, uint64_t rankingPoints) {
+            set_ranking(treasures, iterator, rankingPoints);
+        });
+    }
+
+    [[eosio::action]]
+    void modctypeids(std::vector<std::pair<uint64_t, uint64_t>> updates) 
+    {
+        require_auth("cptblackbill"_n); //Only allowed by cptblackbill contract
+        treasure_index& treasures = tables.treasures();
+        for_each_treasure(treasures, updates, [&](treasure_index::const_iterator iterator, uint64_t cTypeId) {
+            set_ctypeid(treasures, iterator, cTypeId);
+        });
+    }
+
+    //Value is the new expiration date. 0 renews ownership for three years, like modexpdate.
+    [[eosio::action]]
+    void modexpdates(std::vector<std::pair<uint64_t, uint64_t>> updates) 
+    {
+        require_auth("cptblackbill"_n); //Same as modexpdate. Only CptBlackBill has verified the owner on location
+        treasure_index& treasures = tables.treasures();
+        for_each_treasure(treasures, updates, [&](treasure_index::const_iterator iterator, uint64_t expirationDate) {
+            set_expirationdate(treasures, iterator, _self, expirationDate == 0 ? now() + 94608000 : expirationDate);
         });
     }
     /*
@@ -1223,6 +1265,7 @@ public:
     void unlockchest(uint64_t treasurepkey, asset payouteos, name byuser, bool lostdiamondisfound, bool doknowdiamondlocation, 
                      uint64_t sponsoritempkey, name teammember) { 
         require_auth("cptblackbill"_n); //Only allowed by cptblackbill contract
+        TELEMETRY_BEGIN("unlockchest"_n);
 
         //Get total amount in Lost Diamond if diamond is found in this treasure
         //eosio::asset totalamountinlostdiamond = eosio::asset(0, symbol(symbol_code("EOS"), 4));
@@ -1233,53 +1276,47 @@ public:
             //eosio_assert(diamondFundIterator->foundTimestamp == 0, "Diamond is already found.");
             //payouteos = payouteos + diamondFundIterator->diamondValue; //Add lost diamond value to the treasure value
 
-            diamondfund_index diamondfund(_self, _self.value);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
             eosio_assert(diamondFundIterator->foundTimestamp == 0, "Diamond is already found.");
+            TELEMETRY_ADD(rowsread, 2);
             
-            double dblDiamondValue = ((double)diamondFundIterator->diamondValue.amount * 100) / 210; //2023-04-14 TotalValue = X + X + (X * 10/100) = 210X  ::  Conquerer + Owner + 10% to first to know diamond location
-            double dblToFirstToKnowDiamondLocation = dblDiamondValue * 10/100;
-            uint64_t uintDiamondValue = (uint64_t)dblDiamondValue;   
-            uint64_t uintToFirstToKnowDiamondLocation = (uint64_t)dblToFirstToKnowDiamondLocation;   
-            eosio::asset diamondValue = eosio::asset(uintDiamondValue, symbol(symbol_code("EOS"), 4));       
-            eosio::asset toFirstToKnowDiamondLocation = eosio::asset(uintToFirstToKnowDiamondLocation, symbol(symbol_code("EOS"), 4)); 
+            //2023-04-14 TotalValue = X + X + (X * 10/100) = 210X  ::  Conquerer + Owner + 10% to first to know diamond location
+            eosio::asset diamondValue = eosio::asset(money::muldiv(diamondFundIterator->diamondValue.amount, 100, 210), symbol(symbol_code("EOS"), 4));
+            eosio::asset toFirstToKnowDiamondLocation = money::bps(diamondValue, 10 * 100);
             payouteos = payouteos + (diamondValue * 2); //Add lost diamond value to the treasure value. Times 2 because value will be split to owner and conquerer later
         
-            std::string firstToKnowMemo = "Congrats! You knew the location of The Lost Diamond #" + std::to_string(diamondFundIterator->pkey) + " first and get 10 percent of the diamond's value.";
-            action(
-                permission_level{ get_self(), "active"_n },
-                "eosio.token"_n, "transfer"_n,
-                std::make_tuple(get_self(), diamondFundIterator->filocbyacc, toFirstToKnowDiamondLocation, firstToKnowMemo)
-            ).send();
+            send_transfer("eosio.token"_n, diamondFundIterator->filocbyacc, toFirstToKnowDiamondLocation, 
+                          memo_buffer() << "Congrats! You knew the location of The Lost Diamond #" << diamondFundIterator->pkey << " first and get 10 percent of the diamond's value.");
 
             if(diamondFundIterator->toTokenHolders.amount > 0){
-                std::string toTokenHoldersMemo = "Cash dividend to BLKBILL token holders. The Lost Diamond #" + std::to_string(diamondFundIterator->pkey);
-                action(
-                    permission_level{ get_self(), "active"_n },
-                    "eosio.token"_n, "transfer"_n,
-                    std::make_tuple(get_self(), "tldsharehldr"_n, diamondFundIterator->toTokenHolders, toTokenHoldersMemo)
-                ).send();
+                send_transfer("eosio.token"_n, "tldsharehldr"_n, diamondFundIterator->toTokenHolders, 
+                              memo_buffer() << "Cash dividend to BLKBILL token holders. The Lost Diamond #" << diamondFundIterator->pkey);
             }
         }
         else if(doknowdiamondlocation){
             //2023-04-12 The first account(user) that know the location of The Lost Diamond is added to the table and will receive 10% of TLD-value when TLD is found.
-            diamondfund_index diamondfund(_self, _self.value);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
             if(diamondFundIterator->foundTimestamp == 0 && diamondFundIterator->filocTimestamp == 0){
                 diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                     row.filocTimestamp = now(); //First To Know Diamond Location Timestamp
                     row.filocbyacc = byuser; //First To Know Diamond Location Account
                 });  
+                TELEMETRY_ADD(rowswritten, 1);
             }
         }
 
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(treasurepkey);
+        TELEMETRY_ADD(rowsread, 1);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
         name treasureowner = iterator->owner; 
         name treasureConquerer = iterator->conqueredby;
+        treasurestate before = get_treasurestate(*iterator);
 
         treasures.modify(iterator, _self, [&]( auto& row ) {
             row.status = "active";
@@ -1301,24 +1338,23 @@ public:
             //send_summary(treasureowner, "2 BLKBILL token as reward for someone unlocking your treasure.");
             
             //Update 2018-12-28 Add user who unlocked tresure to the result table for easy access on scoreboard in dapp
-            results_index results(_code, _code.value);
-            results.emplace(_self, [&]( auto& row ) { 
-                row.pkey = results.available_primary_key();
-                row.user = byuser; //The eos account that found and unlocked the treasure
-                row.creator = treasureowner; //The eos account that created or owns the treasure
-                row.conqueredby = treasureConquerer; //The eos account that has conquered the treasure and share 50/50 with owner
-                row.treasurepkey = treasurepkey;
-                row.lostdiamondfound = lostdiamondisfound;
-                row.payouteos = payouteos;
-
-                //if(isNoPaymentRobbery == true)
-                //    row.eosusdprice = eosio::asset(0, symbol(symbol_code("USD"), 4)); //2020-04-10 Zero to mark that this is a no payment robbery
-                //else
-                row.eosusdprice = getEosUsdPrice(); //2019-01-08
-                
-                row.minedblkbills = eosio::asset(0, symbol(symbol_code("BLKBILL"), 4));
-                row.timestamp = now();
-            });
+            results result{};
+            result.user = byuser; //The eos account that found and unlocked the treasure
+            result.creator = treasureowner; //The eos account that created or owns the treasure
+            result.conqueredby = treasureConquerer; //The eos account that has conquered the treasure and share 50/50 with owner
+            result.treasurepkey = treasurepkey;
+            result.lostdiamondfound = lostdiamondisfound;
+            result.payouteos = payouteos;
+
+            //if(isNoPaymentRobbery == true)
+            //    result.eosusdprice = eosio::asset(0, symbol(symbol_code("USD"), 4)); //2020-04-10 Zero to mark that this is a no payment robbery
+            //else
+            result.eosusdprice = getEosUsdPrice(); //2019-01-08
+            
+            result.minedblkbills = eosio::asset(0, symbol(symbol_code("BLKBILL"), 4));
+            result.timestamp = now();
+            if(add_result(result)) //Logged results are not in holdings, nothing would remove them
+                update_holdings(byuser, &holdings::wins, result.pkey, 1, payouteos.amount);
 
             //2020-11-29 Conquer is free if correct code. Send payed unlock fee back to user
             //action(
@@ -1331,7 +1367,8 @@ public:
             {
                 //Treasure has been unlocked by <byuser>. 
                 //Split payout amount in two - since both creator and finder get an equal share of the treasure
-                payouteos = payouteos / 2;
+                asset payouteosToCreator = payouteos - money::half(payouteos); //The creator side gets the odd unit
+                payouteos = money::half(payouteos);
 
                 //Transfer treasure chest value to the user who unlocked the treasure
                 if(byuser == "bearland.gm"_n && is_account(teammember)){ //Payout to team-member of bearland.gm 2022-08-05
@@ -1342,52 +1379,26 @@ public:
                     
                     if(teammember == "bearland.gm"_n){
                         //No teammember. Send everyting til byuser account
-                        action(
-                            permission_level{ get_self(), "active"_n },
-                            "eosio.token"_n, "transfer"_n,
-                            std::make_tuple(get_self(), byuser, payouteos, std::string("The Lost Diamond Adventure Race. Congrats for solving checkpoint No." + std::to_string(treasurepkey) + "."))
-                        ).send();    
+                        send_transfer("eosio.token"_n, byuser, payouteos, memo_buffer() << "The Lost Diamond Adventure Race. Congrats for solving checkpoint No." << treasurepkey << ".");
                     }
                     else{
                         if(lostdiamondisfound){
                             //Send 10 percent of the value to teammember
-                            double toTeamMember = (payouteos.amount * 10) / 100;
-                            double toBearland = (payouteos.amount * 90) / 100;
-
-                            uint64_t intToTeamMember = toTeamMember;
-                            asset eosToTeamMember = eosio::asset(intToTeamMember, symbol(symbol_code("EOS"), 4));
-
-                            uint64_t intToBearland = toBearland;
-                            asset eosToBearland = eosio::asset(intToBearland, symbol(symbol_code("EOS"), 4));
-
-                            action(
-                                permission_level{ get_self(), "active"_n },
-                                "eosio.token"_n, "transfer"_n,
-                                std::make_tuple(get_self(), teammember, eosToTeamMember, std::string("The Lost Diamond Adventure Race. 10 percent bonus as Bearland teammember on checkpoint No." + std::to_string(treasurepkey) + "."))
-                            ).send();
-
-                            action(
-                                permission_level{ get_self(), "active"_n },
-                                "eosio.token"_n, "transfer"_n,
-                                std::make_tuple(get_self(), byuser, eosToBearland, std::string("The Lost Diamond Adventure Race. Congrats for solving checkpoint No." + std::to_string(treasurepkey) + "."))
-                            ).send();
+                            asset eosToTeamMember = money::bps(payouteos, 10 * 100);
+                            asset eosToBearland = payouteos - eosToTeamMember; //90 percent (the rest)
+
+                            send_transfer("eosio.token"_n, teammember, eosToTeamMember, memo_buffer() << "The Lost Diamond Adventure Race. 10 percent bonus as Bearland teammember on checkpoint No." << treasurepkey << ".");
+
+                            send_transfer("eosio.token"_n, byuser, eosToBearland, memo_buffer() << "The Lost Diamond Adventure Race. Congrats for solving checkpoint No." << treasurepkey << ".");
                         }
                         else{
                             //Send all to teammember
-                            action(
-                                permission_level{ get_self(), "active"_n },
-                                "eosio.token"_n, "transfer"_n,
-                                std::make_tuple(get_self(), teammember, payouteos, std::string("The Lost Diamond Adventure Race. Bearland teammember payout for checkpoint No." + std::to_string(treasurepkey) + "."))
-                            ).send();
+                            send_transfer("eosio.token"_n, teammember, payouteos, memo_buffer() << "The Lost Diamond Adventure Race. Bearland teammember payout for checkpoint No." << treasurepkey << ".");
                         }   
                     }
                 }
                 else{
-                    action(
-                        permission_level{ get_self(), "active"_n },
-                        "eosio.token"_n, "transfer"_n,
-                        std::make_tuple(get_self(), byuser, payouteos, std::string("Congrats for solving checkpoint No." + std::to_string(treasurepkey) + " on The Lost Diamond!"))
-                    ).send();
+                    send_transfer("eosio.token"_n, byuser, payouteos, memo_buffer() << "Congrats for solving checkpoint No." << treasurepkey << " on The Lost Diamond!");
                 }
                 
 
@@ -1395,101 +1406,89 @@ public:
                 //Share the amount with the conquerer if the treasure has a conquerer
                 if(byuser == treasureowner && is_account(treasureConquerer)){
                     //The treasure owner conquer back ownership to the treasure. Then send the other half to conquerer
-                    action(
-                        permission_level{ get_self(), "active"_n },
-                        "eosio.token"_n, "transfer"_n,
-                        std::make_tuple(get_self(), treasureConquerer, payouteos, std::string("Congrats! Checkpoint No." + std::to_string(treasurepkey) + " has been solved by the owner. This is your equal share of the treasure chest."))
-                    ).send();
+                    send_transfer("eosio.token"_n, treasureConquerer, payouteosToCreator, memo_buffer() << "Congrats! Checkpoint No." << treasurepkey << " has been solved by the owner. This is your equal share of the treasure chest.");
                 }
                 else if(is_account(treasureConquerer)){
-                    asset payouteosToOwner = eosio::asset(payouteos.amount/2, symbol(symbol_code("EOS"), 4));
-                    asset payouteosToConquerer = eosio::asset(payouteos.amount/2, symbol(symbol_code("EOS"), 4));
+                    asset payouteosToOwner = money::half(payouteosToCreator);
+                    asset payouteosToConquerer = payouteosToCreator - payouteosToOwner; //The rest
 
                     if(payouteosToOwner.amount > 0)
                     { 
-                        action(
-                            permission_level{ get_self(), "active"_n },
-                            "eosio.token"_n, "transfer"_n,
-                            std::make_tuple(get_self(), treasureowner, payouteosToOwner, std::string("Congrats! Your Treasure No." + std::to_string(treasurepkey) + " has been solved. You share 50/50 with the current conquerer."))
-                        ).send();
+                        send_transfer("eosio.token"_n, treasureowner, payouteosToOwner, memo_buffer() << "Congrats! Your Treasure No." << treasurepkey << " has been solved. You share 50/50 with the current conquerer.");
                     }
 
                     if(payouteosToConquerer.amount > 0)
                     { 
-                        action(
-                            permission_level{ get_self(), "active"_n },
-                            "eosio.token"_n, "transfer"_n,
-                            std::make_tuple(get_self(), treasureConquerer, payouteosToConquerer, std::string("Congrats! Your conquered treasure No." + std::to_string(treasurepkey) + " has been solved. You share 50/50 with the owner."))
-                        ).send();
+                        send_transfer("eosio.token"_n, treasureConquerer, payouteosToConquerer, memo_buffer() << "Congrats! Your conquered treasure No." << treasurepkey << " has been solved. You share 50/50 with the owner.");
                     }
                 }
                 else{
-                    action(
-                        permission_level{ get_self(), "active"_n },
-                        "eosio.token"_n, "transfer"_n,
-                        std::make_tuple(get_self(), treasureowner, payouteos, std::string("Congrats! Your Treasure No." + std::to_string(treasurepkey) + " has been solved. This is your equal share of the treasure chest."))
-                    ).send();
+                    send_transfer("eosio.token"_n, treasureowner, payouteosToCreator, memo_buffer() << "Congrats! Your Treasure No." << treasurepkey << " has been solved. This is your equal share of the treasure chest.");
                 }                
 
                 if(lostdiamondisfound){
                     //2020-02-29 Mark diamond as found (This will replace the code below.)
                     //This will mark that preparation for payout starts and a new diamond fund is created when 
                     //current diamond owners payout is calculated. 
-                    diamondfund_index diamondfund(_code, _code.value);
+                    diamondfund_index& diamondfund = tables.diamondfund();
                     auto itr = diamondfund.rbegin(); //Find the last added diamond fund item
                     auto iterator = diamondfund.find(itr->pkey);
+                    TELEMETRY_ADD(rowsread, 2);
                     diamondfund.modify(iterator, _self, [&]( auto& row ) {
                         row.foundTimestamp = now();
                         row.foundInTreasurePkey = treasurepkey;
                         row.foundbyacc = byuser;
                     });                     
+                    TELEMETRY_ADD(rowswritten, 1);
                 } 
             }
         });
+        TELEMETRY_ADD(rowswritten, 1);
+        reindex_treasure(treasurepkey, before, get_treasurestate(*iterator));
+        if(iterator->conqueredby != treasureConquerer){
+            update_holdings(treasureConquerer, &holdings::conquered, treasurepkey, -1, 0);
+            update_holdings(iterator->conqueredby, &holdings::conquered, treasurepkey, 1, 0);
+        }
 
         if(sponsoritempkey > 0){ //Sponsor item pKey must always be larger than 0. 
-            sponsoritems_index sponsoritems(_self, _self.value);
+            sponsoritems_index& sponsoritems = tables.sponsoritems();
             auto iterator = sponsoritems.find(sponsoritempkey);
-            asset oneThirdOfAdFeePrice = iterator->adFeePrice / 3;
+            TELEMETRY_ADD(rowsread, 1);
+            asset adFeePrice = iterator->adFeePrice;
+            asset oneThirdOfAdFeePrice = asset(money::muldiv(adFeePrice.amount, 1, 3), adFeePrice.symbol);
             sponsoritems.modify(iterator, _self, [&]( auto& row ) {
                 row.status = "robbed";
                 row.wonby = byuser;
                 row.treasurepkey = treasurepkey;
                 row.wontimestamp = now();
             }); 
+            TELEMETRY_ADD(rowswritten, 1);
 
-            diamondfund_index diamondfund(_self, _self.value);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+            TELEMETRY_ADD(rowsread, 2);
             diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
                 row.toTokenHolders += oneThirdOfAdFeePrice;
             });  
+            TELEMETRY_ADD(rowswritten, 1);
 
             //Share earned advertising amount with the conquerer if the treasure has a conquerer
             if(is_account(treasureConquerer)){
-                action(
-                    permission_level{ get_self(), "active"_n },
-                    "eosio.token"_n, "transfer"_n,
-                    std::make_tuple(get_self(), treasureowner, oneThirdOfAdFeePrice, std::string("Earned advertising fee on Treasure No." + std::to_string(treasurepkey)))
-                ).send();
+                send_transfer("eosio.token"_n, treasureowner, oneThirdOfAdFeePrice, memo_buffer() << "Earned advertising fee on Treasure No." << treasurepkey);
 
                 //Transfer earned fee to treasure owner
-                action(
-                    permission_level{ get_self(), "active"_n },
-                    "eosio.token"_n, "transfer"_n,
-                    std::make_tuple(get_self(), treasureConquerer, oneThirdOfAdFeePrice, std::string("Earned advertising fee on Treasure No." + std::to_string(treasurepkey)))
-                ).send();
+                send_transfer("eosio.token"_n, treasureConquerer, adFeePrice - oneThirdOfAdFeePrice * 2, memo_buffer() << "Earned advertising fee on Treasure No." << treasurepkey);
             }
             else{
-                action(
-                    permission_level{ get_self(), "active"_n },
-                    "eosio.token"_n, "transfer"_n,
-                    std::make_tuple(get_self(), treasureowner, oneThirdOfAdFeePrice * 2, std::string("Earned advertising fee on Treasure No." + std::to_string(treasurepkey)))
-                ).send();
+                send_transfer("eosio.token"_n, treasureowner, adFeePrice - oneThirdOfAdFeePrice, memo_buffer() << "Earned advertising fee on Treasure No." << treasurepkey);
             }
         }
+
+        TELEMETRY_FLUSH();
     }
 
+#ifdef CPTBB_DIAGNOSTICS
     [[eosio::action]]
     void unlocktest(uint64_t treasurepkey, asset payouteos, name byuser, bool lostdiamondisfound, bool doknowdiamondlocation, 
                      uint64_t sponsoritempkey, name teammember) { //bool isNoPaymentRobbery
@@ -1498,33 +1497,65 @@ public:
         //Get total amount in Lost Diamond if diamond is found in this treasure
         //eosio::asset totalamountinlostdiamond = eosio::asset(0, symbol(symbol_code("EOS"), 4));
         if(lostdiamondisfound){
-            diamondfund_index diamondfund(_self, _self.value);
+            diamondfund_index& diamondfund = tables.diamondfund();
             auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
             auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
             eosio_assert(diamondFundIterator->foundTimestamp == 0, "Diamond is already found.");
             
-            double dblDiamondValue = ((double)diamondFundIterator->diamondValue.amount * 100) / 210; //2023-04-14 TotalValue = X + X + (X * 10/100) = 210X  ::  Conquerer + Owner + 10% to first to know diamond location
-            double dblToFirstToKnowDiamondLocation = dblDiamondValue * 10/100;
-            uint64_t uintDiamondValue = (uint64_t)dblDiamondValue;   
-            uint64_t uintToFirstToKnowDiamondLocation = (uint64_t)dblToFirstToKnowDiamondLocation;   
-            
-            eosio::asset diamondValue = eosio::asset(uintDiamondValue, symbol(symbol_code("EOS"), 4));       
-            //eosio::asset toFirstToKnowDiamondLocation = eosio::asset(uintToFirstToKnowDiamondLocation, symbol(symbol_code("EOS"), 4)); 
+            //2023-04-14 TotalValue = X + X + (X * 10/100) = 210X  ::  Conquerer + Owner + 10% to first to know diamond location
+            eosio::asset diamondValue = eosio::asset(money::muldiv(diamondFundIterator->diamondValue.amount, 100, 210), symbol(symbol_code("EOS"), 4));
+            //eosio::asset toFirstToKnowDiamondLocation = money::bps(diamondValue, 10 * 100);
             eosio::asset toFirstToKnowDiamondLocation = eosio::asset(10000, symbol(symbol_code("EOS"), 4)); 
 
             payouteos = payouteos + (diamondValue * 2); //Add lost diamond value to the treasure value. Times 2 because value will be split to owner and conquerer later
         
-            std::string firstToKnowMemo = "TESTING: Congrats! You knew the location of The Lost Diamond #" + std::to_string(diamondFundIterator->pkey) + " first and get 10 percent of the diamond's value.";
-            action(
-                permission_level{ get_self(), "active"_n },
-                "eosio.token"_n, "transfer"_n,
-                std::make_tuple(get_self(), diamondFundIterator->filocbyacc, toFirstToKnowDiamondLocation, firstToKnowMemo)
-            ).send();
+            send_transfer("eosio.token"_n, diamondFundIterator->filocbyacc, toFirstToKnowDiamondLocation, 
+                          memo_buffer() << "TESTING: Congrats! You knew the location of The Lost Diamond #" << diamondFundIterator->pkey << " first and get 10 percent of the diamond's value.");
 
             //std::string debugInfo = "DEBUGTEST: diamondValue: " + std::to_string(diamondValue.amount) + " toFirstToKnowDiamondLocation: " + std::to_string(toFirstToKnowDiamondLocation.amount) + " payouteos: " + std::to_string(payouteos.amount);
             //eosio_assert(1 == 0, debugInfo.c_str());
         }
     }
+#endif
+
+#ifdef CPTBB_DIAGNOSTICS
+    //Hash of the table state, for comparing two contract versions that replayed the same actions.
+    //Read only - prints {"hash":"..","rows":N,"more":false,"cursor":0}. hash is sha256(prev + packed rows) over
+    //maxrows rows from cursor in primary key order. Hash a big table in pages by passing the returned hash as prev
+    //and the returned cursor. tileagg is scoped by zoom level, results by yyyymm
+    //(or the contract account for old results), holdingkey by account, the other tables by the contract account.
+    [[eosio::action]]
+    void statehash(name table, uint64_t scope, uint64_t cursor, uint32_t maxrows, checksum256 prev) {
+        eosio_assert(maxrows > 0, "maxrows must be larger than 0.");
+
+        switch(table.value) {
+            case "treasure"_n.value: { treasure_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "land"_n.value: { land_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "holdings"_n.value: { holdings_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "holdingkey"_n.value: { holdingkey_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "fenwick"_n.value: { fenwick_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "chestalloc"_n.value: { chestalloc_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "tileagg"_n.value: { tileagg_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "diamondfund"_n.value: { diamondfund_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "rndchestfnd"_n.value: { rndchestfnd_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "settings"_n.value: { settings_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "results"_n.value: { results_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "resultscope"_n.value: { resultscope_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "race"_n.value: { race_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "raceresults"_n.value: { raceresults_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "racestanding"_n.value: { racestanding_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "treasuresale"_n.value: { treasuresale_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "sponsoritems"_n.value: { sponsoritems_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "exchngtokens"_n.value: { exchngtokens_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "exchngbuylog"_n.value: { exchngbuylog_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "dimndhistory"_n.value: { dimndhistory_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "timelinelike"_n.value: { timelinelike_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "resultsmnth"_n.value: { resultsmnth_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            case "crewinfo"_n.value: { crewinfo_index t(_self, scope); print_statehash(t, cursor, maxrows, prev); break; }
+            default: eosio_assert(false, "Unknown table.");
+        }
+    }
+#endif
 
     //2020-06-29: For adding race result (members cup and public events) to the result table (to show up on the leaderboard).
     [[eosio::action]]
@@ -1540,18 +1571,17 @@ public:
         cptblackbill::issue(raceowner, eosio::asset(10000, symbol(symbol_code("BLKBILL"), 4)), std::string("Reward for hosting race event.") );
             
         //Add participant to result table. Points == mined black bills
-        results_index results(_code, _code.value);
-        results.emplace(_self, [&]( auto& row ) { 
-            row.pkey = results.available_primary_key();
-            row.user = raceparticipant; //The eos account that found and unlocked the treasure
-            row.creator = raceowner; //The eos account that created or owns the treasure
-            row.treasurepkey = 21; //Race event treasure (pkey=21 does not exists as treasure)
-            row.lostdiamondfound = 0;
-            row.payouteos = eosio::asset(0, symbol(symbol_code("EOS"), 4));;
-            row.eosusdprice = eosio::asset(0, symbol(symbol_code("USD"), 4)); //2020-04-10 Zero to mark that this is a no payment robbery (in this case racing event)
-            row.minedblkbills = eosio::asset(totalpoints, symbol(symbol_code("BLKBILL"), 4));
-            row.timestamp = endracetimestamp;
-        });
+        results result{};
+        result.user = raceparticipant; //The eos account that found and unlocked the treasure
+        result.creator = raceowner; //The eos account that created or owns the treasure
+        result.treasurepkey = 21; //Race event treasure (pkey=21 does not exists as treasure)
+        result.lostdiamondfound = 0;
+        result.payouteos = eosio::asset(0, symbol(symbol_code("EOS"), 4));
+        result.eosusdprice = eosio::asset(0, symbol(symbol_code("USD"), 4)); //2020-04-10 Zero to mark that this is a no payment robbery (in this case racing event)
+        result.minedblkbills = eosio::asset(totalpoints, symbol(symbol_code("BLKBILL"), 4));
+        result.timestamp = endracetimestamp;
+        if(add_result(result)) //Logged results are not in holdings, nothing would remove them
+            update_holdings(raceparticipant, &holdings::wins, result.pkey, 1, 0);
     }
 
     [[eosio::action]]
@@ -1564,7 +1594,7 @@ public:
         eosio_assert(resultmnthItr == resultsmnth.end(), "Monthly ranking award already exists.");
 
         //Get current diamond value
-        diamondfund_index diamondfund(_self, _self.value);
+        diamondfund_index& diamondfund = tables.diamondfund();
         auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
         auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
         asset diamondValue = diamondFundIterator->diamondValue;
@@ -1572,20 +1602,15 @@ public:
         eosio_assert(diamondFundIterator->foundTimestamp == 0, "Diamond is already found. No prize available.");
     
         //Get award amount for first, second and third place
-        double firstPlaceAward = (diamondValue.amount * 2.5) / 100; //2.5 percent (is actually 5 percent of the diamond value)
-        double secondPlaceAward = (diamondValue.amount * 1.5) / 100; //1.5 percent (3 percent)
-        double thirdPlaceAward = (diamondValue.amount * 1) / 100; //1 percent (2 percent)
-        double totalAwardInEos = firstPlaceAward + secondPlaceAward + thirdPlaceAward;
-
-        uint64_t intFirstPlaceaward = firstPlaceAward;
-        uint64_t intSecondPlaceAward = secondPlaceAward;
-        uint64_t intThirdPlaceAward = thirdPlaceAward;
+        asset eosFirstPlaceaward = money::bps(diamondValue, 250); //2.5 percent (is actually 5 percent of the diamond value)
+        asset eosSecondPlaceAward = money::bps(diamondValue, 150); //1.5 percent (3 percent)
+        asset eosThirdPlaceAward = money::bps(diamondValue, 100); //1 percent (2 percent)
+
+        uint64_t intFirstPlaceaward = eosFirstPlaceaward.amount;
+        uint64_t intSecondPlaceAward = eosSecondPlaceAward.amount;
+        uint64_t intThirdPlaceAward = eosThirdPlaceAward.amount;
         uint64_t intRemainingDiamondValue = diamondValue.amount; 
         
-        asset eosFirstPlaceaward = eosio::asset(intFirstPlaceaward, symbol(symbol_code("EOS"), 4));
-        asset eosSecondPlaceAward = eosio::asset(intSecondPlaceAward, symbol(symbol_code("EOS"), 4));
-        asset eosThirdPlaceAward = eosio::asset(intThirdPlaceAward, symbol(symbol_code("EOS"), 4));
-        
         resultsmnth.emplace(_self, [&]( auto& row ) { 
             row.pkey = yyyymm; 
             row.fpAccount = fpAccount;
@@ -1604,31 +1629,19 @@ public:
         //Payout to fp, sp and tp
         if(fpPoints > 0 && intFirstPlaceaward > 0)
         { 
-            action(
-                permission_level{ get_self(), "active"_n },
-                "eosio.token"_n, "transfer"_n,
-                std::make_tuple(get_self(), fpAccount, eosFirstPlaceaward, std::string("Congrats! You won the last month competition with " + std::to_string(fpPoints) + " points."))
-            ).send();
+            send_transfer("eosio.token"_n, fpAccount, eosFirstPlaceaward, memo_buffer() << "Congrats! You won the last month competition with " << fpPoints << " points.");
             intRemainingDiamondValue = intRemainingDiamondValue - intFirstPlaceaward;
         }
 
         if(spPoints > 0 && intSecondPlaceAward > 0)
         { 
-            action(
-                permission_level{ get_self(), "active"_n },
-                "eosio.token"_n, "transfer"_n,
-                std::make_tuple(get_self(), spAccount, eosSecondPlaceAward, std::string("Congrats! You won second place in the last month competition with " + std::to_string(spPoints) + " points."))
-            ).send();
+            send_transfer("eosio.token"_n, spAccount, eosSecondPlaceAward, memo_buffer() << "Congrats! You won second place in the last month competition with " << spPoints << " points.");
             intRemainingDiamondValue = intRemainingDiamondValue - intSecondPlaceAward;
         }
 
         if(tpPoints > 0 && intThirdPlaceAward > 0)
         { 
-            action(
-                permission_level{ get_self(), "active"_n },
-                "eosio.token"_n, "transfer"_n,
-                std::make_tuple(get_self(), tpAccount, eosThirdPlaceAward, std::string("Congrats! You won third place in the last month competition with " + std::to_string(tpPoints) + " points."))
-            ).send();
+            send_transfer("eosio.token"_n, tpAccount, eosThirdPlaceAward, memo_buffer() << "Congrats! You won third place in the last month competition with " << tpPoints << " points.");
             intRemainingDiamondValue = intRemainingDiamondValue - intThirdPlaceAward;
         }
 
@@ -1639,6 +1652,8 @@ public:
         });
     }
 
+#ifdef CPTBB_DIAGNOSTICS
+    //Test and one-off migration actions. Only compiled into the diagnostics contract.
     [[eosio::action]]
     void btulla(name byuser, uint64_t fromPkey, asset testeos, uint64_t toPkey) {
         require_auth("cptblackbill"_n);
@@ -1976,7 +1991,7 @@ public:
         require_auth("cptblackbill"_n);
 
         //Find and get info about the current diamond
-        diamondfund_index diamondfund(_code, _code.value);
+        diamondfund_index& diamondfund = tables.diamondfund();
         auto lastAddedDiamondItr = diamondfund.rbegin(); //Find the last added diamond fund item
         auto dmndFundItr = diamondfund.find(lastAddedDiamondItr->pkey);
         eosio_assert(dmndFundItr != diamondfund.end(), "No active diamond found");
@@ -2016,7 +2031,7 @@ public:
         require_auth("cptblackbill"_n);
 
         //Check that the current diamond is found
-        diamondfund_index diamondfund(_code, _code.value);
+        diamondfund_index& diamondfund = tables.diamondfund();
         auto lastAddedDiamondItr = diamondfund.rbegin(); //Find the last added diamond fund item
         auto dmndFundItr = diamondfund.find(lastAddedDiamondItr->pkey);
         eosio_assert(dmndFundItr->foundTimestamp > 0, "The current diamond has not been found. Payout preparation for diamond owners is not possible.");
@@ -2120,24 +2135,22 @@ public:
         }
         */
     }
+#endif
 
     [[eosio::action]]
     void modexpdate(name user, uint64_t pkey) {
         require_auth("cptblackbill"_n); //"Updating expiration date is only allowed by CptBlackBill. This is to make sure (verified gps location by CptBlackBill) that the owner has actually been on location and entered secret code
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure not found");
-        
-        treasures.modify(iterator, user, [&]( auto& row ) {
-            row.expirationdate = now() + 94608000; //Treasure ownership renewed for three years
-        });
+        set_expirationdate(treasures, iterator, user, now() + 94608000); //Treasure ownership renewed for three years
     }
 
     [[eosio::action]]
     void resetsecretc(name user, uint64_t pkey) {
         require_auth(user);
         
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure does not exist.");
@@ -2145,31 +2158,268 @@ public:
         //cptsambelamy is janitor and allowed to replace secret codes on behalf of everyone
         //eosio_assert(iterator->status == "active", "Treasure is not active.");
         
+        treasurestate before = get_treasurestate(*iterator);
         treasures.modify(iterator, _self, [&]( auto& row ) {
             row.status = "active";
             row.ctypeid = 0;
             row.banditalarms = 0;
             row.expirationdate = now() + 94608000; //Treasure ownership renewed for three years
         });
+        reindex_treasure(pkey, before, get_treasurestate(*iterator));
     }
 
     [[eosio::action]]
     void erasetreasur(name user, uint64_t pkey) {
         require_auth(user);
         
-        treasure_index treasures(_code, _code.value);
+        treasure_index& treasures = tables.treasures();
         
         auto iterator = treasures.find(pkey);
         eosio_assert(iterator != treasures.end(), "Treasure does not exist.");
         eosio_assert(user == iterator->owner || user == "cptblackbill"_n, "You don't have access to remove this treasure.");
+
+        //Release the land
+        treasurestate before = get_treasurestate(*iterator);
+        land_index& lands = tables.lands();
+        auto landItr = find_land(lands, *iterator);
+        if(landItr != lands.end())
+            lands.erase(landItr);
+        reindex_treasure(pkey, before, treasurestate{});
+        update_holdings(iterator->owner, &holdings::checkpoints, pkey, -1, 0);
+        update_holdings(iterator->conqueredby, &holdings::conquered, pkey, -1, 0);
+
         treasures.erase(iterator);
     }
 
+    //Start a migration of table rows (see migrate_step). Only one migration can run at a time.
+    [[eosio::action]]
+    void startmigr(uint64_t id) {
+        require_auth("cptblackbill"_n);
+
+        migration_singleton migrations(_self, _self.value);
+        auto state = migrations.get_or_default();
+        eosio_assert(state.active == 0, "Another migration is running.");
+        eosio_assert(!migration_completed(id), "Migration is already completed.");
+        eosio_assert(id >= migrLand && id <= migrHoldingWins, "Unknown migration.");
+
+        state.active = id;
+        state.cursor = 0;
+        state.processed = 0;
+        state.keptcount = 0;
+        state.kept.clear();
+        migrations.set(state, _self);
+    }
+
+    //Run the active migration for up to maxrows rows from where the last call stopped. Prints progress as
+    //{"id":N,"cursor":N,"processed":N,"keptcount":N,"kept":[pkey,...],"done":true|false}
+    [[eosio::action]]
+    void migrate(uint32_t maxrows) {
+        require_auth("cptblackbill"_n);
+
+        migration_singleton migrations(_self, _self.value);
+        auto state = migrations.get_or_default();
+        eosio_assert(state.active != 0, "No migration is running.");
+
+        uint64_t id = state.active;
+        bool done = migrate_step(state, maxrows);
+        if(done){
+            state.completed.push_back(id);
+            state.active = 0;
+        }
+        migrations.set(state, _self);
+        print("{\"id\":", id, ",\"cursor\":", state.cursor, ",\"processed\":", state.processed, ",\"keptcount\":", state.keptcount, ",\"kept\":[");
+        for(size_t i = 0; i < state.kept.size(); i++) {
+            if(i > 0)
+                print(",");
+            print(state.kept[i]);
+        }
+        print("],\"done\":", done ? "true" : "false", "}");
+    }
+
+    //Active checkpoints inside a map viewport. Read only - prints
+    //{"rows":[[pkey,latitude,longitude,ctypeid,rankingpoint],...],"more":true|false,"cursor":N}
+    //The box is split into at most 64 map tiles that are range scanned on the land table in tile key order.
+    //Call again with the returned cursor while more is true. Start with cursor 0.
+    [[eosio::action]]
+    void viewport(double minlat, double minlon, double maxlat, double maxlon, uint32_t limit, uint64_t cursor) {
+        eosio_assert(minlat <= maxlat && minlon <= maxlon, "Invalid bounding box.");
+        eosio_assert(limit > 0 && limit <= 100, "Limit must be between 1 and 100.");
+
+        //The most detailed zoom level where the box covers no more than 64 tiles
+        int zoom = maptile::landZoom;
+        uint32_t x0, x1, y0, y1;
+        for(;; zoom--) {
+            x0 = maptile::clamptile(maptile::tilex(minlon, zoom), zoom);
+            x1 = maptile::clamptile(maptile::tilex(maxlon, zoom), zoom);
+            y0 = maptile::clamptile(maptile::tiley(maxlat, zoom), zoom); //Tile y grows southwards
+            y1 = maptile::clamptile(maptile::tiley(minlat, zoom), zoom);
+            if(zoom == 0 || (uint64_t)(x1 - x0 + 1) * (y1 - y0 + 1) <= 64)
+                break;
+        }
+
+        std::vector<uint64_t> cells;
+        for(uint32_t x = x0; x <= x1; x++)
+            for(uint32_t y = y0; y <= y1; y++)
+                cells.push_back(maptile::morton(x, y));
+        std::sort(cells.begin(), cells.end());
+
+        land_index& lands = tables.lands();
+        treasure_index& treasures = tables.treasures();
+        int shift = 2 * (maptile::landZoom - zoom);
+        uint32_t found = 0;
+        uint32_t scanned = 0;
+        bool more = false;
+
+        print("{\"rows\":[");
+        for(uint64_t cell : cells) {
+            uint64_t endKey = (cell + 1) << shift;
+            if(endKey <= cursor)
+                continue;
+
+            auto itr = lands.lower_bound(std::max(cell << shift, cursor));
+            for(; itr != lands.end() && itr->tilekey < endKey; itr++) {
+                if(found == limit || scanned == limit * 10){ //Keep the scan bounded when the box is mostly empty
+                    more = true;
+                    cursor = itr->tilekey;
+                    break;
+                }
+                scanned++;
+
+                auto treasureItr = treasures.find(itr->treasurepkey);
+                if(treasureItr == treasures.end() || treasureItr->status != "active" ||
+                   treasureItr->latitude < minlat || treasureItr->latitude > maxlat ||
+                   treasureItr->longitude < minlon || treasureItr->longitude > maxlon)
+                    continue;
+
+                if(found > 0)
+                    print(",");
+                print("[", treasureItr->pkey, ",", treasureItr->latitude, ",", treasureItr->longitude, ",",
+                      treasureItr->ctypeid, ",", treasureItr->rankingpoint, "]");
+                found++;
+            }
+            if(more)
+                break;
+        }
+        print("],\"more\":", more ? "true" : "false", ",\"cursor\":", more ? cursor : 0, "}");
+    }
+
+    //The n nearest active checkpoints. Read only - prints {"rows":[[pkey,distance],...]} sorted by
+    //distance in meters. ctypeids filters on checkpoint type (empty = all types). Searches rings of zoom 14 map
+    //tiles around the position and stops when the rest of the rings can't be closer than the n found.
+    [[eosio::action]]
+    void nearby(double latitude, double longitude, uint32_t n, std::vector<uint64_t> ctypeids) {
+        eosio_assert(n > 0 && n <= 50, "n must be between 1 and 50.");
+        eosio_assert(latitude >= -85.0511 && latitude <= 85.0511 && longitude >= -180 && longitude <= 180, "Invalid GPS coordinate.");
+
+        const int zoom = 14;
+        const int maxRings = 8;
+        const uint32_t maxScan = 500;
+        const double earthRadius = 6371008.8;
+        const double degToRad = M_PI / 180.0;
+        //Ground width of a map tile at this latitude. A checkpoint outside ring r is at least r tile widths away.
+        double tileMeters = 2 * M_PI * earthRadius * cos(latitude * degToRad) / (1 << zoom);
+        int cx = maptile::tilex(longitude, zoom);
+        int cy = maptile::tiley(latitude, zoom);
+        int shift = 2 * (maptile::landZoom - zoom);
+
+        land_index& lands = tables.lands();
+        treasure_index& treasures = tables.treasures();
+        std::vector<std::pair<uint64_t, uint64_t>> nearest; //distance, pkey
+        uint32_t scanned = 0;
+
+        for(int r = 0; r <= maxRings && scanned < maxScan; r++) {
+            for(int dx = -r; dx <= r; dx++) {
+                for(int dy = -r; dy <= r; dy++) {
+                    if(std::abs(dx) != r && std::abs(dy) != r) //Only the tiles on the edge of the ring
+                        continue;
+                    int x = cx + dx;
+                    int y = cy + dy;
+                    if(x < 0 || y < 0 || x >= (1 << zoom) || y >= (1 << zoom))
+                        continue;
+
+                    uint64_t cell = maptile::morton(x, y);
+                    uint64_t endKey = (cell + 1) << shift;
+                    for(auto itr = lands.lower_bound(cell << shift); itr != lands.end() && itr->tilekey < endKey && scanned < maxScan; itr++) {
+                        scanned++;
+                        auto treasureItr = treasures.find(itr->treasurepkey);
+                        if(treasureItr == treasures.end() || treasureItr->status != "active")
+                            continue;
+                        if(!ctypeids.empty() && std::find(ctypeids.begin(), ctypeids.end(), treasureItr->ctypeid) == ctypeids.end())
+                            continue;
+
+                        //Equirectangular approximation. Good enough on the distances searched here.
+                        double east = (treasureItr->longitude - longitude) * degToRad * cos((treasureItr->latitude + latitude) / 2 * degToRad);
+                        double north = (treasureItr->latitude - latitude) * degToRad;
+                        uint64_t distance = (uint64_t)(sqrt(east * east + north * north) * earthRadius);
+
+                        if(nearest.size() == n && distance >= nearest.back().first)
+                            continue;
+                        nearest.insert(std::upper_bound(nearest.begin(), nearest.end(), std::make_pair(distance, treasureItr->pkey)), 
+                                       std::make_pair(distance, treasureItr->pkey));
+                        if(nearest.size() > n)
+                            nearest.pop_back();
+                    }
+                }
+            }
+
+            if(nearest.size() == n && nearest.back().first <= r * tileMeters)
+                break;
+        }
+
+        print("{\"rows\":[");
+        for(size_t i = 0; i < nearest.size(); i++) {
+            if(i > 0)
+                print(",");
+            print("[", nearest[i].second, ",", nearest[i].first, "]");
+        }
+        print("]}");
+    }
+
+    //Checkpoints, conquered checkpoints, listings, sell orders and wins for an account. Read only - prints
+    //{"checkpoints":{"count":N,"total":N,"pkeys":[...]},"conquered":{...},"listings":{...},"sellorders":{...},"wins":{...}}
+    [[eosio::action]]
+    void portfolio(name account) {
+        holdings_index& holdingsTable = tables.holdings();
+        auto itr = holdingsTable.find(account.value);
+        holdings h = (itr == holdingsTable.end()) ? holdings{account} : *itr;
+
+        print("{");
+        print_holdinglist("checkpoints", h.checkpoints);
+        print(",");
+        print_holdinglist("conquered", h.conquered);
+        print(",");
+        print_holdinglist("listings", h.listings);
+        print(",");
+        print_holdinglist("sellorders", h.sellorders);
+        print(",");
+        print_holdinglist("wins", h.wins);
+        print("}");
+    }
+
+    //Leaderboard of a race. Read only - prints {"rows":[[teamaccount,points,checkpoints,lasttimestamp],...]}
+    //with the leader first.
+    [[eosio::action]]
+    void standings(uint64_t racepkey, uint32_t limit) {
+        eosio_assert(limit > 0 && limit <= 100, "Limit must be between 1 and 100.");
+
+        racestanding_index standings(_self, racepkey);
+        auto byRank = standings.get_index<"rank"_n>();
+        uint32_t found = 0;
+
+        print("{\"rows\":[");
+        for(auto itr = byRank.begin(); itr != byRank.end() && found < limit; itr++, found++) {
+            if(found > 0)
+                print(",");
+            print("[\"", itr->teamaccount, "\",", itr->points, ",", itr->checkpoints, ",", itr->lasttimestamp, "]");
+        }
+        print("]}");
+    }
+
     [[eosio::action]]
     void erasesellord(name user, uint64_t pkey) {
         require_auth(user);
         
-        exchngtokens_index exchngtokens(_code, _code.value);
+        exchngtokens_index& exchngtokens = tables.exchngtokens();
         
         auto iterator = exchngtokens.find(pkey);
         eosio_assert(iterator != exchngtokens.end(), "Sell order does not exist.");
@@ -2178,17 +2428,11 @@ public:
         eosio_assert(iterator->sell.amount >= 0, "Only sell orders with real quantity can be cancelled.");
 
         //Transfer BLKBILL tokens back to account
-            action(
-                permission_level{ get_self(), "active"_n },
-                "cptblackbill"_n, "transfer"_n,
-                std::make_tuple(get_self(), 
-                                iterator->account,  
-                                iterator->sell, 
-                                std::string("Returned BLKBILL tokens from cancelled sell order."))
-            ).send();
+        send_transfer("cptblackbill"_n, iterator->account, iterator->sell, memo_buffer() << "Returned BLKBILL tokens from cancelled sell order.");
 
         //iterator->sell
         
+        update_holdings(iterator->account, &holdings::sellorders, pkey, -1, -iterator->sell.amount);
         exchngtokens.erase(iterator);
     }
 
@@ -2270,20 +2514,41 @@ public:
         require_auth(teamaccount);
         
         eosio_assert(points > 0, "Must have points for storing results.");
+        eosio_assert(points <= maxRaceCheckpointPoints, "Too many points for one checkpoint.");
+        race_index& race = tables.race();
+        eosio_assert(race.find(racepkey) != race.end(), "Race not found");
         
-        raceresults_index raceresults(_code, _code.value);
-        raceresults.emplace(_self, [&]( auto& row ) {
-            row.pkey = raceresults.available_primary_key();
-            row.teamaccount = teamaccount;
-            row.racepkey = racepkey;
-            row.checkpointname = checkpointname;
-            row.points = points;
-            row.totalpoints = totalPoints;
-            row.latitude = latitude;
-            row.longitude = longitude;
-            row.creator = checkpointcreator;
-            row.timestamp = now();
-        });
+        raceresults racecheckpoint{};
+        racecheckpoint.teamaccount = teamaccount;
+        racecheckpoint.racepkey = racepkey;
+        racecheckpoint.checkpointname = checkpointname;
+        racecheckpoint.points = points;
+        racecheckpoint.totalpoints = totalPoints;
+        racecheckpoint.latitude = latitude;
+        racecheckpoint.longitude = longitude;
+        racecheckpoint.creator = checkpointcreator;
+        racecheckpoint.timestamp = now();
+        add_history(tables.raceresults(), &historyseq::nextracerslt, "logracecp"_n, racecheckpoint);
+
+        //Team totals are summed here. totalPoints from the client is only kept in raceresults. The points
+        //are reported by the team, so the standings are only as good as the clients (bounded per checkpoint).
+        racestanding_index standings(_self, racepkey);
+        auto standingItr = standings.find(teamaccount.value);
+        if(standingItr == standings.end()){
+            standings.emplace(_self, [&]( auto& row ) {
+                row.teamaccount = teamaccount;
+                row.points = points;
+                row.checkpoints = 1;
+                row.lasttimestamp = now();
+            });
+        }
+        else{
+            standings.modify(standingItr, same_payer, [&]( auto& row ) {
+                row.points += points;
+                row.checkpoints++;
+                row.lasttimestamp = now();
+            });
+        }
 
         //The participants (teamaccount) is racing and race payment can be transfered to race owner, the lost diamond and token holders.
         //racepayments{
@@ -2314,14 +2579,17 @@ public:
     void clearacerslt() 
     {
         require_auth("cptblackbill"_n);
+        TELEMETRY_BEGIN("clearacerslt"_n);
         
         //Remove race results older than 24 hours
-        raceresults_index raceresults(_self, _self.value);
+        raceresults_index& raceresults = tables.raceresults();
         auto raceresultsItr = raceresults.begin();
         uint64_t counter = 0;
         while(raceresultsItr != raceresults.end()) {
+            TELEMETRY_ADD(rowsread, 1);
             if(raceresultsItr->timestamp < (now() - 86400)){ //Timestamp older than 24 hours
                 raceresultsItr = raceresults.erase(raceresultsItr);
+                TELEMETRY_ADD(rowswritten, 1);
             } 
 
             //Prevent deadline exceeded error
@@ -2330,17 +2598,68 @@ public:
                 break;
             }
         }
+
+        TELEMETRY_FLUSH();
     }
 
+    //Delete the standing and the results of a team in a race. The standing is erased by the first call.
+    //Erases up to 500 results per call, call again until it prints done:true. When historylog is logged the results
+    //were only sent as logracecp actions and are not in raceresults, so only the standing is erased. Readers of
+    //the log must drop the team's logracecp actions themselves when they see delracersult.
     [[eosio::action]]
     void delracersult(uint64_t raceId, eosio::name teamaccount) {
         require_auth("cptblackbill"_n);
+        TELEMETRY_BEGIN("delracersult"_n);
+
+        racestanding_index standings(_self, raceId);
+        auto standingItr = standings.find(teamaccount.value);
+        TELEMETRY_ADD(rowsread, 1);
+        if(standingItr != standings.end()){
+            standings.erase(standingItr);
+            TELEMETRY_ADD(rowswritten, 1);
+        }
         
-        raceresults_index raceresults(_self, _self.value);
-        auto itr = raceresults.begin();
-        while(itr != raceresults.end()) {
-            itr = raceresults.erase(itr);
+        raceresults_index& raceresults = tables.raceresults();
+        auto byRace = raceresults.get_index<"racepkey"_n>();
+        auto itr = byRace.lower_bound(raceId);
+        uint64_t counter = 0;
+        while(itr != byRace.end() && itr->racepkey == raceId && counter < 500) {
+            TELEMETRY_ADD(rowsread, 1);
+            if(itr->teamaccount == teamaccount){
+                itr = byRace.erase(itr);
+                TELEMETRY_ADD(rowswritten, 1);
+            }
+            else{
+                itr++;
+            }
+            counter++;
         } 
+
+        bool done = itr == byRace.end() || itr->racepkey != raceId;
+        print("{\"done\":", done ? "true" : "false", "}");
+
+        TELEMETRY_FLUSH();
+    }
+
+    //Delete the standings of a finished race. Erases up to maxrows teams per call, call again until
+    //it prints done:true. Race results are pruned separately by clearacerslt.
+    [[eosio::action]]
+    void delstandings(uint64_t racepkey, uint32_t maxrows) {
+        require_auth("cptblackbill"_n);
+        TELEMETRY_BEGIN("delstandings"_n);
+        eosio_assert(maxrows > 0, "maxrows must be larger than 0.");
+
+        racestanding_index standings(_self, racepkey);
+        uint32_t erased = 0;
+        auto itr = standings.begin();
+        for(; itr != standings.end() && erased < maxrows; erased++) {
+            itr = standings.erase(itr);
+        }
+        TELEMETRY_ADD(rowsread, erased);
+        TELEMETRY_ADD(rowswritten, erased);
+        print("{\"done\":", itr == standings.end() ? "true" : "false", "}");
+
+        TELEMETRY_FLUSH();
     }
 
     [[eosio::action]]
@@ -2348,7 +2667,7 @@ public:
     {
         require_auth("cptblackbill"_n);
         
-        settings_index settings(_code, _code.value);
+        settings_index& settings = tables.settings();
         
         settings.emplace(_self, [&]( auto& row ) { //The user who run the transaction is RAM payer. So if added from CptBlackBill dapp, CptBlackBill is responsible for RAM.
             row.keyname = keyname; // pkey = settings.available_primary_key();
@@ -2364,7 +2683,7 @@ public:
     void modsetting(name keyname, std::string stringvalue, asset assetvalue, uint32_t uintvalue) 
     {
         require_auth("cptblackbill"_n);
-        settings_index settings(_code, _code.value);
+        settings_index& settings = tables.settings();
         auto iterator = settings.find(keyname.value);
         eosio_assert(iterator != settings.end(), "Setting not found");
         
@@ -2381,7 +2700,7 @@ public:
     {
         require_auth(waccount);
         eosio::name keyname = "accusr"_n; 
-        settings_index settings(_code, _code.value);
+        settings_index& settings = tables.settings();
         auto iterator = settings.find(keyname.value);
         eosio_assert(iterator != settings.end(), "Setting not found");
         
@@ -2395,9 +2714,10 @@ public:
     void erasesetting(name keyname) {
         require_auth("cptblackbill"_n);
         
-        settings_index settings(_code, _code.value);
+        settings_index& settings = tables.settings();
         auto iterator = settings.find(keyname.value);
         eosio_assert(iterator != settings.end(), "Setting does not exist");
+        eosio_assert(keyname != "historylog"_n, "Set historylog to 0 instead. Without it logged history pkeys could be used again.");
         settings.erase(iterator);
     }
 
@@ -2405,24 +2725,40 @@ public:
     void eraseresult(uint64_t pkey) {
         require_auth("cptblackbill"_n);
         
-        results_index results(_code, _code.value);
+        results_index results(_self, result_scope(pkey));
         auto iterator = results.find(pkey);
         eosio_assert(iterator != results.end(), "Result does not exist.");
+        update_holdings(iterator->user, &holdings::wins, pkey, -1, -iterator->payouteos.amount);
         results.erase(iterator);
+
+        if((pkey >> 32) > 0){
+            resultscope_index& scopes = tables.resultscopes();
+            auto scopeItr = scopes.find(pkey >> 32);
+            eosio_assert(scopeItr != scopes.end(), "Result month not found.");
+            scopes.modify(scopeItr, same_payer, [&]( auto& row ) {
+                row.rows--;
+            });
+        }
     }
 
+    //Prunes results older than 30 days: first the results stored before the monthly scopes (scope _self), then
+    //whole months that ended more than 30 days ago (see dropmonth). Up to 500 results per call.
     [[eosio::action]]
     void clearresult() //2024-05-21
     {
         require_auth("cptblackbill"_n);
+        TELEMETRY_BEGIN("clearresult"_n);
         
-        //Remove race results older than 24 hours
-        results_index results(_self, _self.value);
+        //Remove results older than 30 days
+        results_index& results = tables.results();
         auto resultsItr = results.begin();
         uint64_t counter = 0;
         while(resultsItr != results.end()) {
+            TELEMETRY_ADD(rowsread, 1);
             if(resultsItr->timestamp < (now() - 2592000)){ //Timestamp older than 30 days
+                update_holdings(resultsItr->user, &holdings::wins, resultsItr->pkey, -1, -resultsItr->payouteos.amount);
                 resultsItr = results.erase(resultsItr);
+                TELEMETRY_ADD(rowswritten, 1);
             } 
 
             //Prevent deadline exceeded error
@@ -2431,6 +2767,34 @@ public:
                 break;
             }
         }
+
+        //Retire the months where every result is older than 30 days
+        uint64_t expiredMonth = calendar::yyyymm(now() - 2592000);
+        resultscope_index& scopes = tables.resultscopes();
+        for(auto scopeItr = scopes.begin(); scopeItr != scopes.end() && scopeItr->yyyymm < expiredMonth && counter <= 500; scopeItr++) {
+            TELEMETRY_ADD(rowsread, 1);
+            if(scopeItr->rows > 0 || !scopeItr->retired)
+                counter += drop_month(scopes, scopeItr, 501 - counter);
+        }
+
+        TELEMETRY_FLUSH();
+    }
+
+    //Retire the results of a month. Erases up to maxrows results of the month per call, call again until
+    //resultscope.rows is 0. The month stays in resultscope marked as retired, so its pkeys are never used again.
+    [[eosio::action]]
+    void dropmonth(uint64_t yyyymm, uint32_t maxrows) {
+        require_auth("cptblackbill"_n);
+        TELEMETRY_BEGIN("dropmonth"_n);
+        eosio_assert(maxrows > 0, "maxrows must be larger than 0.");
+
+        resultscope_index& scopes = tables.resultscopes();
+        auto scopeItr = scopes.find(yyyymm);
+        eosio_assert(scopeItr != scopes.end(), "No results for this month.");
+        eosio_assert(yyyymm < calendar::yyyymm(now()), "The current month can't be retired.");
+        drop_month(scopes, scopeItr, maxrows);
+
+        TELEMETRY_FLUSH();
     }
 
     /*
@@ -2448,7 +2812,7 @@ public:
     void exechestfnd(uint64_t pkey) {
         require_auth("cptblackbill"_n);
         
-        rndchestfnd_index rndchestfnd(_code, _code.value);
+        rndchestfnd_index& rndchestfnd = tables.rndchestfnd();
         auto iterator = rndchestfnd.find(pkey);
         eosio_assert(iterator != rndchestfnd.end(), "Chest funding not found");
         
@@ -2457,12 +2821,84 @@ public:
         });
     }
 
+    //Execute pending RandomChestFunding deposits in order. Each deposit is split with integer math on
+    //random checkpoints (weighted by rankingpoint) and recorded in chestalloc. Deposits for countries can't be
+    //resolved on-chain and are left for exechestfnd. max limits deposits visited plus checkpoints drawn per call.
+    //The draws use the seed committed by commitseed, so every call needs a new commitseed first.
+    [[eosio::action]]
+    void execchestbatch(std::string seed, uint32_t max) {
+        require_auth("cptblackbill"_n);
+
+        const uint64_t maxChestsPerDeposit = 50;
+        const uint64_t maxChestUsd = 1000000; //ChestAmount above this is treated as missing
+        eosio_assert(max > maxChestsPerDeposit, "max must cover one deposit split on the maximum number of checkpoints.");
+
+        seedcommit commit = reveal_seed(seed);
+        chestcursor_singleton chestcursor(_self, _self.value);
+        auto cursor = chestcursor.get_or_default();
+        rndchestfnd_index& rndchestfnd = tables.rndchestfnd();
+        asset eosusd = getEosUsdPrice();
+        uint32_t budget = max;
+        uint32_t executedCount = 0;
+
+        auto itr = rndchestfnd.lower_bound(cursor.nextpkey);
+        for(; itr != rndchestfnd.end() && budget > 0; itr++) {
+            if(!itr->executed && itr->memo.find("ChestAmount:") == std::string::npos && itr->memo.find(':') != std::string::npos){
+                budget--; //Country funding
+            }
+            else if(!itr->executed){
+                //Number of checkpoints. The whole deposit to one checkpoint unless a valid USD amount per chest is given.
+                uint64_t chests = 1;
+                size_t chestAmountPos = itr->memo.find("ChestAmount:");
+                if(chestAmountPos != std::string::npos && eosusd.amount > 0){
+                    uint64_t chestUsd = std::strtoull(itr->memo.substr(chestAmountPos + 12).c_str(), NULL, 10);
+                    if(chestUsd > 0 && chestUsd <= maxChestUsd){
+                        asset chestEos = money::usd_to_eos(asset(chestUsd * 10000, symbol(symbol_code("USD"), 4)), eosusd);
+                        if(chestEos.amount > 0)
+                            chests = std::max<uint64_t>(1, itr->amount.amount / chestEos.amount);
+                    }
+                }
+                chests = std::min(chests, maxChestsPerDeposit);
+                if(1 + chests > budget)
+                    break; //Left for the next call. The first deposit always fits since max > maxChestsPerDeposit
+
+                //Stop if there is nothing to draw from. This and the remaining deposits stay pending.
+                std::string depositSeed = seed + ":" + std::to_string(itr->pkey);
+                uint64_t treasurepkey;
+                if(!draw_treasure(depositSeed, commit.committed, treasurepkey))
+                    break;
+                budget -= 1 + chests;
+
+                //Split exactly. The first (amount % chests) checkpoints get 0.0001 more.
+                uint64_t share = itr->amount.amount / chests;
+                uint64_t remainder = itr->amount.amount % chests;
+                for(uint64_t i = 0; i < chests; i++) {
+                    if(i > 0) //Weights don't change while splitting, so this draw can't fail when the first didn't
+                        eosio_assert(draw_treasure(depositSeed, commit.committed + i, treasurepkey), "No active checkpoints to draw from.");
+                    add_chestalloc(treasurepkey, asset(share + (i < remainder ? 1 : 0), itr->amount.symbol), "chestfund"_n, itr->pkey);
+                }
+
+                rndchestfnd.modify(itr, _self, [&]( auto& row ) {
+                    row.executed = true;
+                });
+                executedCount++;
+            }
+            else{
+                budget--;
+            }
+            cursor.nextpkey = itr->pkey + 1;
+        }
+
+        chestcursor.set(cursor, _self);
+        print("executed:", executedCount, " nextpkey:", cursor.nextpkey);
+    }
+
     [[eosio::action]]
     void modrace(eosio::name raceowner, uint64_t racepkey, std::string title, asset entryfeeusd, std::string jsonracedata) 
     {
         require_auth(raceowner);
         
-        race_index race(_code, _code.value);
+        race_index& race = tables.race();
         auto iterator = race.find(racepkey);
         eosio_assert(iterator != race.end(), "Race not found");
         
@@ -2508,35 +2944,40 @@ public:
     }
 
     [[eosio::action]]
-    void adddimndhst(uint64_t treasurepkey, asset diamondValueInEos, asset diamondValueInUsd, int32_t fromTimestamp, int32_t toTimestamp)
+    void adddimndhst(uint64_t treasurepkey, asset diamondValueInEos, asset diamondValueInUsd, int32_t fromTimestamp, int32_t toTimestamp, std::string seed)
     {
         require_auth("cptblackbill"_n);
+        seedcommit commit = reveal_seed(seed);
 
         eosio_assert(treasurepkey >= 0, "Invalid treasure pKey.");
         
-        dimndhistory_index dimndhistory(_code, _code.value);
-        
-        dimndhistory.emplace(_self, [&]( auto& row ) {
-            row.pkey = dimndhistory.available_primary_key();
-            row.treasurepkey = treasurepkey;
-            row.diamondValueInEos = diamondValueInEos;
-            row.diamondValueInUsd = diamondValueInUsd;
-            row.fromTimestamp = fromTimestamp;
-            row.toTimestamp = toTimestamp;
-        });
+        dimndhistory_index dimndhistorytable(_code, _code.value);
+        dimndhistory relocation{};
+        relocation.treasurepkey = treasurepkey;
+        relocation.diamondValueInEos = diamondValueInEos;
+        relocation.diamondValueInUsd = diamondValueInUsd;
+        relocation.fromTimestamp = fromTimestamp;
+        relocation.toTimestamp = toTimestamp;
+        add_history(dimndhistorytable, &historyseq::nextdimndhst, "logrelocate"_n, relocation);
         
-        //Remove 2% of the diamond value. That amount is added to a random treasure in the RelocateTheLostDiamond function
-        diamondfund_index diamondfund(_self, _self.value);
+        //Remove 1% of the diamond value. That amount is added to a random treasure in the RelocateTheLostDiamond function
+        diamondfund_index& diamondfund = tables.diamondfund();
         auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
         auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
         asset diamondValue = diamondFundIterator->diamondValue;
         
-        double dblToRandomTreasure = (diamondValue.amount * 1.0) / 100; //1.0 percent (is actually 2 percent of the diamond value)
-        uint64_t intToRandomTreasure = dblToRandomTreasure;
-        uint64_t intRemainingDiamondValue = diamondValue.amount - intToRandomTreasure; 
+        uint64_t intToRandomTreasure = money::bps(diamondValue, 100).amount; //1.0 percent
+
+        //The random treasure is drawn on-chain (weighted by rankingpoint) with the seed committed by
+        //commitseed. The value stays in the diamond if there is no checkpoint to draw.
+        uint64_t randomTreasurePkey;
+        if(intToRandomTreasure > 0 && draw_treasure(seed, commit.committed, randomTreasurePkey))
+            add_chestalloc(randomTreasurePkey, eosio::asset(intToRandomTreasure, symbol(symbol_code("EOS"), 4)), "diamond"_n, relocation.pkey);
+        else
+            intToRandomTreasure = 0;
 
         //Update new amount for diamond value
-        asset eosRemainingDiamondValue = eosio::asset(intRemainingDiamondValue, symbol(symbol_code("EOS"), 4));
+        asset eosRemainingDiamondValue = eosio::asset(diamondValue.amount - intToRandomTreasure, symbol(symbol_code("EOS"), 4));
         diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
             row.diamondValue = eosRemainingDiamondValue;
             row.filocTimestamp = 0; //2023-05-03 Remove account that was first to know diamond location
@@ -2544,6 +2985,42 @@ public:
         });
     }
 
+    //Commit-reveal for the random draws (execchestbatch, adddimndhst, drawchest). Cpt.BlackBill commits
+    //sha256(seed) and reveals the seed in the draw action. The checkpoint weights are locked from the commit until
+    //the reveal (see fenwick_add), and the draw only depends on the seed and the commit time, so neither the
+    //weights nor anything in the reveal transaction can change the result.
+    [[eosio::action]]
+    void commitseed(checksum256 seedhash) {
+        require_auth("cptblackbill"_n);
+        seedcommit_singleton seedcommits(_self, _self.value);
+        eosio_assert(!seedcommits.exists(), "A seed is already committed.");
+        seedcommits.set(seedcommit{seedhash, now()}, _self);
+    }
+
+    //Draw a random checkpoint (weighted by rankingpoint) with the seed committed by commitseed and move amount
+    //from the diamond to it
+    [[eosio::action]]
+    void drawchest(std::string seed, asset amount) {
+        require_auth("cptblackbill"_n);
+        seedcommit commit = reveal_seed(seed);
+        eosio_assert(amount.symbol == symbol(symbol_code("EOS"), 4) && amount.amount > 0, "Amount must be a positive EOS amount.");
+
+        diamondfund_index& diamondfund = tables.diamondfund();
+        auto diamondFundItr = diamondfund.rbegin(); //Find the last added diamond fund item
+        eosio_assert(diamondFundItr != diamondfund.rend(), "No diamond fund.");
+        auto diamondFundIterator = diamondfund.find(diamondFundItr->pkey);
+        eosio_assert(diamondFundIterator->foundTimestamp == 0, "Diamond is already found. No value available.");
+        eosio_assert(amount.amount <= diamondFundIterator->diamondValue.amount, "Amount is larger than the diamond value.");
+
+        uint64_t treasurepkey;
+        eosio_assert(draw_treasure(seed, commit.committed, treasurepkey), "No active checkpoints to draw from.");
+        add_chestalloc(treasurepkey, amount, "draw"_n, diamondFundIterator->pkey);
+        diamondfund.modify(diamondFundIterator, _self, [&]( auto& row ) {
+            row.diamondValue -= amount;
+        });
+        print("treasurepkey:", treasurepkey);
+    }
+
     [[eosio::action]]
     void addsponsitm(std::string sponsorname, std::string imageurl, std::string description,
                      std::string targeturl, asset usdvalue, asset adFeePrice) 
@@ -2556,7 +3033,7 @@ public:
         eosio_assert(usdvalue.amount >= 1000, "Minimum USD value for sponsored item is 10 dollar.");
         eosio_assert(adFeePrice.amount >= 10, "Minimum EOS value for advertising fee is 0.0010 EOS.");
 
-        sponsoritems_index sponsoritems(_code, _code.value);
+        sponsoritems_index& sponsoritems = tables.sponsoritems();
         sponsoritems.emplace(_self, [&]( auto& row ) {
             row.pkey = sponsoritems.available_primary_key();
             row.sponsorname = sponsorname;
@@ -2575,13 +3052,32 @@ public:
     void erasesponitm(uint64_t pkey) {
         require_auth("cptblackbill"_n);
         
-        sponsoritems_index sponsoritems(_code, _code.value);
+        sponsoritems_index& sponsoritems = tables.sponsoritems();
         
         auto iterator = sponsoritems.find(pkey);
         eosio_assert(iterator != sponsoritems.end(), "Sponsor item does not exist.");
         sponsoritems.erase(iterator);
     }
 
+#ifdef CPTBB_TELEMETRY
+    //Read-only. Prints the hot path counters as json (push with --dry-run / read the action console).
+    [[eosio::action]]
+    void gettelemetry() {
+        telemetry_singleton tlm(_self, _self.value);
+        auto stats = tlm.get_or_default();
+
+        print("[");
+        for(size_t i = 0; i < stats.counters.size(); i++) {
+            const auto& c = stats.counters[i];
+            if(i > 0)
+                print(",");
+            print("{\"action\":\"", c.action, "\",\"invocations\":", c.invocations, ",\"rowsread\":", c.rowsread,
+                  ",\"rowswritten\":", c.rowswritten, ",\"inlineactions\":", c.inlineactions, ",\"bytesemplaced\":", c.bytesemplaced, "}");
+        }
+        print("]");
+    }
+#endif
+
     /*[[eosio::action]]
     void runpayout(name user) {
         require_auth("cptbbpayout1"_n);
@@ -2603,6 +3099,47 @@ private:
     typedef eosio::multi_index< "accounts"_n, account > accounts;
     typedef eosio::multi_index< "stat"_n, currency_stats > stats;
 
+#ifdef CPTBB_TELEMETRY
+    struct actcounter {
+        eosio::name action; //Action name, or "tr.<command>" for the memo commands in onTransfer
+        uint64_t invocations;
+        uint64_t rowsread;
+        uint64_t rowswritten;
+        uint64_t inlineactions;
+        uint64_t bytesemplaced;
+    };
+
+    struct [[eosio::table]] telemetry {
+        std::vector<actcounter> counters;
+    };
+    typedef eosio::singleton<"telemetry"_n, telemetry> telemetry_singleton;
+
+    actcounter _tlm{};
+
+    //Add the counters collected during this action to the telemetry singleton. One read and one write.
+    void flush_telemetry() {
+        telemetry_singleton tlm(_self, _self.value);
+        auto stats = tlm.get_or_default();
+
+        bool found = false;
+        for(auto& c : stats.counters) {
+            if(c.action == _tlm.action) {
+                c.invocations += _tlm.invocations;
+                c.rowsread += _tlm.rowsread;
+                c.rowswritten += _tlm.rowswritten;
+                c.inlineactions += _tlm.inlineactions;
+                c.bytesemplaced += _tlm.bytesemplaced;
+                found = true;
+                break;
+            }
+        }
+        if(!found)
+            stats.counters.push_back(_tlm);
+
+        tlm.set(stats, _self);
+    }
+#endif
+
     struct [[eosio::table]] treasure {
         uint64_t pkey;
         eosio::name owner;
@@ -2625,6 +3162,9 @@ private:
         eosio::name conqueredby; //If someone has robbed and conquered the treasure. Conquered by user will get 75% of the treasure value next time it's robbed. The owner will still get 25%
         std::string conqueredimg; //The user who conquered can add another image to the treasure.
         std::string jsondata;  //additional field for other info in json format.
+        //Layout version 2 (migration migrFixedCoords). GPS coordinate in 1/10^7 degrees.
+        eosio::binary_extension<int32_t> latitudee7;
+        eosio::binary_extension<int32_t> longitudee7;
         uint64_t primary_key() const { return  pkey; }
         uint64_t by_owner() const {return owner.value; } //second key, can be non-unique
         double by_latitude() const {return latitude; } //third key, can be non-unique
@@ -2637,7 +3177,112 @@ private:
             eosio::indexed_by<"tileidxy"_n, const_mem_fun<treasure, double, &treasure::by_tileid>>,
             eosio::indexed_by<"ctypeid"_n, const_mem_fun<treasure, uint64_t, &treasure::by_ctypeid>>> treasure_index;
 
-    struct [[eosio::table]] checkpoint {
+    //Land ownership. One row per zoom 17 map tile with a checkpoint on it. The map reads this table
+    //directly for tile occupancy.
+    struct [[eosio::table]] land {
+        uint64_t tilekey; //Morton key of the zoom 17 map tile (maptile::tilekey)
+        eosio::name owner;
+        uint64_t treasurepkey;
+
+        uint64_t primary_key() const { return  tilekey; }
+    };
+    typedef eosio::multi_index<"land"_n, land> land_index;
+
+    //Portfolio per account (see portfolio). Updated by every action that changes ownership of
+    //checkpoints, listings, sell orders or results. pkeys keeps the newest maxHoldingPkeys of each list.
+    struct holdinglist {
+        uint32_t count;
+        int64_t total; //listings: asking price USD, sellorders: BLKBILL for sale, wins: payout EOS
+        std::vector<uint64_t> pkeys;
+    };
+
+    struct [[eosio::table]] holdings {
+        eosio::name account;
+        holdinglist checkpoints; //treasure pkeys owned
+        holdinglist conquered; //treasure pkeys where account is conqueredby
+        holdinglist listings; //treasure pkeys for sale (treasuresale)
+        holdinglist sellorders; //exchngtokens pkeys
+        holdinglist wins; //results pkeys
+
+        uint64_t primary_key() const { return  account.value; }
+    };
+    typedef eosio::multi_index<"holdings"_n, holdings> holdings_index;
+
+    //The holdings lists of an account (scope) that count pkey. Holdings from before the holdings table existed
+    //have no row here, and update_holdings ignores changes to them until the migrations migrHoldingCheckpoints,
+    //migrHoldingListings, migrHoldingSellOrders and migrHoldingWins have counted them.
+    //RAM paid by the contract: about 121 bytes per counted pkey here (9 bytes plus about 112 bytes per row) and
+    //73 to 873 bytes plus 112 per account in holdings (up to maxHoldingPkeys pkeys per list).
+    struct [[eosio::table]] holdingkey {
+        uint64_t pkey;
+        uint8_t lists; //One bit per holdinglist (see holdinglist_bit)
+
+        uint64_t primary_key() const { return  pkey; }
+    };
+    typedef eosio::multi_index<"holdingkey"_n, holdingkey> holdingkey_index;
+
+    //Fenwick tree for weighted random checkpoint selection (see draw_treasure). Weight is rankingpoint
+    //for active checkpoints with land, else 0.
+    struct [[eosio::table]] fenwick {
+        uint64_t page;
+        std::vector<uint64_t> sums; //fenwickPageSize nodes
+
+        uint64_t primary_key() const { return  page; }
+    };
+    typedef eosio::multi_index<"fenwick"_n, fenwick> fenwick_index;
+
+    struct [[eosio::table]] fenwickcfg {
+        uint64_t capacity; //Number of nodes. Power of two
+        uint64_t draws; //Number of random draws so far
+    };
+    typedef eosio::singleton<"fenwickcfg"_n, fenwickcfg> fenwickcfg_singleton;
+
+    //Committed hash of the seed for the next random draw
+    struct [[eosio::table]] seedcommit {
+        checksum256 seedhash;
+        uint32_t committed; //Time of commitseed. Mixed into the draw
+    };
+    typedef eosio::singleton<"seedcommit"_n, seedcommit> seedcommit_singleton;
+
+    //Checkpoints drawn for random funding. Read by the chest funding and diamond relocation jobs.
+    struct [[eosio::table]] chestalloc {
+        uint64_t pkey;
+        uint64_t treasurepkey;
+        eosio::asset amount;
+        eosio::name source; //diamond, draw, chestfund
+        uint64_t sourcepkey; //pkey in dimndhistory for diamond, in rndchestfnd for chestfund, in diamondfund for draw
+        int32_t timestamp;
+
+        uint64_t primary_key() const { return  pkey; }
+    };
+    typedef eosio::multi_index<"chestalloc"_n, chestalloc> chestalloc_index;
+
+    //Clustered map. Active checkpoints (with land) per map tile on zoom level 8, 11 and 14
+    //(maptile::clusterZooms). Scope is the zoom level, primary key is the Morton key of the tile on that zoom level.
+    struct [[eosio::table]] tileagg {
+        uint64_t tilekey;
+        uint64_t activecount;
+        uint64_t rankingpoints; //Sum of rankingpoint for the active checkpoints
+        uint64_t reppkey; //A checkpoint in the tile (active if possible) to show for the cluster. 0 if none was found
+
+        uint64_t primary_key() const { return  tilekey; }
+    };
+    typedef eosio::multi_index<"tileagg"_n, tileagg> tileagg_index;
+
+    //State of the table migrations (startmigr, migrate)
+    struct [[eosio::table]] migration {
+        uint64_t active; //Id of the running migration. 0 if none
+        uint64_t cursor; //Next primary key to migrate
+        uint64_t processed; //Rows migrated so far
+        uint64_t keptcount; //Rows left as they are (migrDropCheckpoint: checkpoint rows that differ from treasure)
+        std::vector<uint64_t> kept; //pkeys of the last maxKeptPkeys kept rows
+        std::vector<uint64_t> completed; //Ids of completed migrations
+    };
+    typedef eosio::singleton<"migration"_n, migration> migration_singleton;
+
+    //Retired. A copy of treasure made by one-off migrations in btulla. Not in the ABI anymore. Only used
+    //by migration migrDropCheckpoint to erase the remaining rows. Do not write to this table.
+    struct checkpoint {
         uint64_t pkey;
         eosio::name owner;
         std::string title; 
@@ -2670,7 +3315,7 @@ private:
             eosio::indexed_by<"owner"_n, const_mem_fun<checkpoint, uint64_t, &checkpoint::by_owner>>,
             eosio::indexed_by<"latitude"_n, const_mem_fun<checkpoint, double, &checkpoint::by_latitude>>,
             eosio::indexed_by<"tileidxy"_n, const_mem_fun<checkpoint, double, &checkpoint::by_tileid>>,
-            eosio::indexed_by<"ctypeid"_n, const_mem_fun<checkpoint, uint64_t, &checkpoint::by_ctypeid>>> checkpoint_index;
+            eosio::indexed_by<"ctypeid"_n, const_mem_fun<checkpoint, uint64_t, &checkpoint::by_ctypeid>>> legacy_checkpoint_index;
 
     /*
     struct [[eosio::table]] tcrfund {
@@ -2754,6 +3399,12 @@ private:
         uint64_t primary_key() const { return  pkey; }
     };
     typedef eosio::multi_index<"rndchestfnd"_n, rndchestfnd> rndchestfnd_index;
+
+    //Where execchestbatch continues. Deposits get increasing pkeys, so everything below nextpkey is done.
+    struct [[eosio::table]] chestcursor {
+        uint64_t nextpkey;
+    };
+    typedef eosio::singleton<"chestcursor"_n, chestcursor> chestcursor_singleton;
     
     struct [[eosio::table]] settings {
         eosio::name keyname; 
@@ -2788,6 +3439,17 @@ private:
             eosio::indexed_by<"creator"_n, const_mem_fun<results, uint64_t, &results::by_creator>>, 
             eosio::indexed_by<"treasurepkey"_n, const_mem_fun<results, uint64_t, &results::by_treasurepkey>>> results_index;
 
+    //Months with results (scope of results, see add_result)
+    struct [[eosio::table]] resultscope {
+        uint64_t yyyymm;
+        uint64_t nextpkey; //pkey of the next result in this month. Also counts results sent as log actions
+        uint64_t rows; //Results stored in the scope
+        bool retired; //Dropped with dropmonth. No new results for this month
+
+        uint64_t primary_key() const { return yyyymm; }
+    };
+    typedef eosio::multi_index<"resultscope"_n, resultscope> resultscope_index;
+
     
     struct [[eosio::table]] race {
         uint64_t pkey;
@@ -2825,6 +3487,20 @@ private:
             eosio::indexed_by<"creator"_n, const_mem_fun<raceresults, uint64_t, &raceresults::by_creator>>, 
             eosio::indexed_by<"racepkey"_n, const_mem_fun<raceresults, uint64_t, &raceresults::by_racepkey>>> raceresults_index;
 
+    //Running totals per team in a race. Scope is racepkey. Updated by addracerslt, so the leaderboard
+    //of a race is one ordered scan of the rank index (see standings).
+    struct [[eosio::table]] racestanding {
+        eosio::name teamaccount;
+        uint64_t points; //Sum of the points of the solved checkpoints
+        uint32_t checkpoints; //Solved checkpoints
+        uint32_t lasttimestamp; //When the last checkpoint was solved
+
+        uint64_t primary_key() const { return teamaccount.value; }
+        uint64_t by_rank() const { return ((uint64_t)(UINT32_MAX - std::min(points, (uint64_t)UINT32_MAX)) << 32) | lasttimestamp; } //Most points first. Equal points: first to reach them first
+    };
+    typedef eosio::multi_index<"racestanding"_n, racestanding, 
+            eosio::indexed_by<"rank"_n, const_mem_fun<racestanding, uint64_t, &racestanding::by_rank>>> racestanding_index;
+
     struct [[eosio::table]] racepayments {
         uint64_t pkey;
         uint64_t racepkey;
@@ -2973,6 +3649,91 @@ private:
     };
     typedef eosio::multi_index<"exchngbuylog"_n, exchngbuylog, 
             eosio::indexed_by<"toaccount"_n, const_mem_fun<exchngbuylog, uint64_t, &exchngbuylog::by_toaccount>>> exchngbuylog_index; 
+
+    //Next pkey of each history table for events emitted as log actions (see add_history)
+    struct [[eosio::table]] historyseq {
+        uint64_t nextbuylog;
+        uint64_t nextdimndhst;
+        uint64_t nextracerslt;
+    };
+    typedef eosio::singleton<"historyseq"_n, historyseq> historyseq_singleton;
+
+public:
+    //History events, sent inline by the contract itself when the setting "historylog" is on (see add_history).
+    //Nothing is stored. Indexers read the rows from the action traces.
+    [[eosio::action]]
+    void logunlock(results result) {
+        require_auth(_self);
+    }
+
+    [[eosio::action]]
+    void logfill(exchngbuylog fill) {
+        require_auth(_self);
+    }
+
+    [[eosio::action]]
+    void logrelocate(dimndhistory relocation) {
+        require_auth(_self);
+    }
+
+    [[eosio::action]]
+    void logracecp(raceresults racecheckpoint) {
+        require_auth(_self);
+    }
+
+private:
+    //Table handles shared by the action and all helpers it calls. A multi_index keeps the rows it has
+    //read in a cache, so every new handle to the same table reads and deserializes the rows again. Each table is
+    //opened on first use. The contract object lives for one action only, so the handles do too.
+    class tablecontext {
+    public:
+        explicit tablecontext(name self) : self(self) {}
+
+        treasure_index& treasures() { return open(_treasures); }
+        land_index& lands() { return open(_lands); }
+        holdings_index& holdings() { return open(_holdings); }
+        fenwick_index& fenwick() { return open(_fenwick); }
+        chestalloc_index& chestallocs() { return open(_chestallocs); }
+        diamondfund_index& diamondfund() { return open(_diamondfund); }
+        rndchestfnd_index& rndchestfnd() { return open(_rndchestfnd); }
+        settings_index& settings() { return open(_settings); }
+        results_index& results() { return open(_results); }
+        resultscope_index& resultscopes() { return open(_resultscopes); }
+        race_index& race() { return open(_race); }
+        raceresults_index& raceresults() { return open(_raceresults); }
+        treasuresale_index& treasuresales() { return open(_treasuresales); }
+        sponsoritems_index& sponsoritems() { return open(_sponsoritems); }
+        exchngtokens_index& exchngtokens() { return open(_exchngtokens); }
+        exchngbuylog_index& exchngbuylog() { return open(_exchngbuylog); }
+
+    private:
+        template<typename T>
+        T& open(std::optional<T>& table) {
+            if(!table)
+                table.emplace(self, self.value);
+            return *table;
+        }
+
+        name self;
+        std::optional<treasure_index> _treasures;
+        std::optional<land_index> _lands;
+        std::optional<holdings_index> _holdings;
+        std::optional<fenwick_index> _fenwick;
+        std::optional<chestalloc_index> _chestallocs;
+        std::optional<diamondfund_index> _diamondfund;
+        std::optional<rndchestfnd_index> _rndchestfnd;
+        std::optional<settings_index> _settings;
+        std::optional<results_index> _results;
+        std::optional<resultscope_index> _resultscopes;
+        std::optional<race_index> _race;
+        std::optional<raceresults_index> _raceresults;
+        std::optional<treasuresale_index> _treasuresales;
+        std::optional<sponsoritems_index> _sponsoritems;
+        std::optional<exchngtokens_index> _exchngtokens;
+        std::optional<exchngbuylog_index> _exchngbuylog;
+    };
+
+    tablecontext tables;
     
     
     /*void send_summary(name user, std::string message) {
@@ -2984,16 +3745,729 @@ private:
         ).send();
     };*/
 
+    //Land row owned by the treasure, or lands.end() if the treasure has no land registered (yet)
+    land_index::const_iterator find_land(land_index& lands, const treasure& t) {
+        auto itr = lands.find(maptile::tilekey(t.latitude, t.longitude, maptile::landZoom));
+        if(itr != lands.end() && itr->treasurepkey != t.pkey)
+            return lands.end();
+        return itr;
+    }
+
+    static constexpr uint32_t maxHoldingPkeys = 20;
+
+    //Highest sell order price in the BLKBILL transfer memo (cent per token)
+    static constexpr uint64_t maxSellPriceCents = 100000000;
+
+    //Highest points a team can report for one race checkpoint (see addracerslt)
+    static constexpr uint32_t maxRaceCheckpointPoints = 1000;
+
+    //Bit of list in holdingkey.lists
+    static uint8_t holdinglist_bit(holdinglist holdings::* list) {
+        if(list == &holdings::checkpoints) return 1;
+        if(list == &holdings::conquered) return 2;
+        if(list == &holdings::listings) return 4;
+        if(list == &holdings::sellorders) return 8;
+        return 16; //wins
+    }
+
+    //countDelta 1 adds pkey to the list, -1 removes it, 0 only changes the total
+    void update_holdings(name account, holdinglist holdings::* list, uint64_t pkey, int32_t countDelta, int64_t amountDelta) {
+        if(account == ""_n)
+            return;
+
+        //Only change holdings this table has counted. Others were held before the holdings table existed.
+        holdingkey_index keys(_self, account.value);
+        auto keyItr = keys.find(pkey);
+        TELEMETRY_ADD(rowsread, 1);
+        uint8_t bit = holdinglist_bit(list);
+        bool counted = keyItr != keys.end() && (keyItr->lists & bit) != 0;
+        if(countDelta <= 0 ? !counted : counted)
+            return;
+
+        if(countDelta > 0 && keyItr == keys.end()){
+            keys.emplace(_self, [&]( auto& row ) {
+                row.pkey = pkey;
+                row.lists = bit;
+            });
+        }
+        else if(countDelta > 0){
+            keys.modify(keyItr, _self, [&]( auto& row ) {
+                row.lists |= bit;
+            });
+        }
+        else if(countDelta < 0 && keyItr->lists == bit){
+            keys.erase(keyItr);
+        }
+        else if(countDelta < 0){
+            keys.modify(keyItr, _self, [&]( auto& row ) {
+                row.lists &= ~bit;
+            });
+        }
+        if(countDelta != 0){
+            TELEMETRY_ADD(rowswritten, 1);
+        }
+
+        holdings_index& holdingsTable = tables.holdings();
+        auto itr = holdingsTable.find(account.value);
+        TELEMETRY_ADD(rowsread, 1);
+        TELEMETRY_ADD(rowswritten, 1);
+        if(itr == holdingsTable.end()){
+            itr = holdingsTable.emplace(_self, [&]( auto& row ) {
+                row.account = account;
+            });
+        }
+
+        holdings h = *itr;
+        holdinglist& l = h.*list;
+        l.count += countDelta;
+        l.total += amountDelta;
+        if(countDelta > 0){
+            l.pkeys.push_back(pkey);
+            if(l.pkeys.size() > maxHoldingPkeys)
+                l.pkeys.erase(l.pkeys.begin());
+        }
+        else if(countDelta < 0){
+            l.pkeys.erase(std::remove(l.pkeys.begin(), l.pkeys.end(), pkey), l.pkeys.end());
+        }
+
+        if(h.checkpoints.count == 0 && h.conquered.count == 0 && h.listings.count == 0 && h.sellorders.count == 0 && h.wins.count == 0){
+            holdingsTable.erase(itr);
+        }
+        else{
+            holdingsTable.modify(itr, _self, [&]( auto& row ) {
+                row = h;
+            });
+        }
+    }
+
+    void print_holdinglist(const char* listname, const holdinglist& l) {
+        print("\"", listname, "\":{\"count\":", l.count, ",\"total\":", l.total, ",\"pkeys\":[");
+        for(size_t i = 0; i < l.pkeys.size(); i++) {
+            if(i > 0)
+                print(",");
+            print(l.pkeys[i]);
+        }
+        print("]}");
+    }
+
+#ifdef CPTBB_DIAGNOSTICS
+    template<typename Table>
+    void print_statehash(Table& table, uint64_t cursor, uint32_t maxrows, const checksum256& prev) {
+        auto prevBytes = prev.extract_as_byte_array();
+        std::vector<char> buffer(prevBytes.begin(), prevBytes.end());
+
+        uint32_t rows = 0;
+        auto itr = table.lower_bound(cursor);
+        for(; itr != table.end() && rows < maxrows; itr++, rows++) {
+            std::vector<char> packed = eosio::pack(*itr);
+            buffer.insert(buffer.end(), packed.begin(), packed.end());
+        }
+
+        auto hash = eosio::sha256(buffer.data(), buffer.size()).extract_as_byte_array();
+        print("{\"hash\":\"");
+        printhex(hash.data(), hash.size());
+        print("\",\"rows\":", rows, ",\"more\":", itr != table.end() ? "true" : "false",
+              ",\"cursor\":", itr != table.end() ? itr->primary_key() : 0, "}");
+    }
+#endif
+
+    //---Migrations----------------------------------------------------------------------------------------
+    //Register land, map tile aggregates and Fenwick weights for checkpoints minted before the land table existed
+    static constexpr uint64_t migrLand = 1;
+    //Fill latitudee7 and longitudee7 (treasure layout version 2)
+    static constexpr uint64_t migrFixedCoords = 2;
+    //Verify the checkpoint table against treasure and erase the copies
+    static constexpr uint64_t migrDropCheckpoint = 3;
+    //Count the holdings that existed before the holdings table: treasure owner and conqueredby, treasuresale,
+    //exchngtokens and stored results. update_holdings skips pkeys that are already counted, so the migrations can
+    //run while the contract is in use.
+    static constexpr uint64_t migrHoldingCheckpoints = 4;
+    static constexpr uint64_t migrHoldingListings = 5;
+    static constexpr uint64_t migrHoldingSellOrders = 6;
+    static constexpr uint64_t migrHoldingWins = 7;
+
+    bool migration_completed(uint64_t id) {
+        auto state = migration_singleton(_self, _self.value).get_or_default();
+        TELEMETRY_ADD(rowsread, 1);
+        return std::find(state.completed.begin(), state.completed.end(), id) != state.completed.end();
+    }
+
+    //Migrate up to maxrows rows from the cursor. Returns true when the last row is migrated.
+    bool migrate_step(migration& state, uint32_t maxrows) {
+        if(state.active == migrDropCheckpoint)
+            return drain_checkpoints(state, maxrows);
+        if(state.active == migrHoldingListings)
+            return backfill_listings(state, maxrows);
+        if(state.active == migrHoldingSellOrders)
+            return backfill_sellorders(state, maxrows);
+        if(state.active == migrHoldingWins)
+            return backfill_wins(state, maxrows);
+
+        treasure_index& treasures = tables.treasures();
+        auto itr = treasures.lower_bound(state.cursor);
+        for(uint32_t counter = 0; itr != treasures.end() && counter < maxrows; itr++, counter++) {
+            switch(state.active) {
+                case migrLand:
+                    migrate_land(*itr);
+                    break;
+                case migrFixedCoords:
+                    if(!itr->latitudee7.has_value() || !itr->longitudee7.has_value()){
+                        treasures.modify(itr, _self, [&]( auto& row ) {
+                            row.latitudee7 = maptile::fixedcoord(row.latitude);
+                            row.longitudee7 = maptile::fixedcoord(row.longitude);
+                        });
+                    }
+                    break;
+                case migrHoldingCheckpoints:
+                    update_holdings(itr->owner, &holdings::checkpoints, itr->pkey, 1, 0);
+                    update_holdings(itr->conqueredby, &holdings::conquered, itr->pkey, 1, 0);
+                    break;
+                default:
+                    eosio_assert(false, "Unknown migration.");
+            }
+            state.cursor = itr->pkey + 1;
+            state.processed++;
+        }
+        return itr == treasures.end();
+    }
+
+    static constexpr uint32_t maxKeptPkeys = 20;
+
+    //Erase checkpoint rows that are copies of a treasure (same pkey and every field equal). Other rows are kept
+    //for a manual check. state.kept lists the last maxKeptPkeys of them.
+    bool drain_checkpoints(migration& state, uint32_t maxrows) {
+        legacy_checkpoint_index checkpoints(_self, _self.value);
+        treasure_index& treasures = tables.treasures();
+        auto itr = checkpoints.lower_bound(state.cursor);
+        for(uint32_t counter = 0; itr != checkpoints.end() && counter < maxrows; counter++) {
+            state.cursor = itr->pkey + 1;
+            state.processed++;
+
+            auto treasureItr = treasures.find(itr->pkey);
+            if(treasureItr != treasures.end() && is_copy(*itr, *treasureItr)){
+                itr = checkpoints.erase(itr);
+            }
+            else{
+                state.keptcount++;
+                state.kept.push_back(itr->pkey);
+                if(state.kept.size() > maxKeptPkeys)
+                    state.kept.erase(state.kept.begin());
+                itr++;
+            }
+        }
+        return itr == checkpoints.end();
+    }
+
+    bool backfill_listings(migration& state, uint32_t maxrows) {
+        treasuresale_index& treasuresales = tables.treasuresales();
+        auto itr = treasuresales.lower_bound(state.cursor);
+        for(uint32_t counter = 0; itr != treasuresales.end() && counter < maxrows; itr++, counter++) {
+            update_holdings(itr->account, &holdings::listings, itr->treasurepkey, 1, itr->askingpriceUsd.amount);
+            state.cursor = itr->pkey + 1;
+            state.processed++;
+        }
+        return itr == treasuresales.end();
+    }
+
+    bool backfill_sellorders(migration& state, uint32_t maxrows) {
+        exchngtokens_index& exchngtokens = tables.exchngtokens();
+        auto itr = exchngtokens.lower_bound(state.cursor);
+        for(uint32_t counter = 0; itr != exchngtokens.end() && counter < maxrows; itr++, counter++) {
+            update_holdings(itr->account, &holdings::sellorders, itr->pkey, 1, itr->sell.amount);
+            state.cursor = itr->pkey + 1;
+            state.processed++;
+        }
+        return itr == exchngtokens.end();
+    }
+
+    //The results in scope cptblackbill first, then each month in resultscope. The cursor is a result pkey, so
+    //it also gives the scope (see result_scope).
+    bool backfill_wins(migration& state, uint32_t maxrows) {
+        resultscope_index& scopes = tables.resultscopes();
+        uint32_t counter = 0;
+        while(counter < maxrows) {
+            results_index results(_self, result_scope(state.cursor));
+            auto itr = results.lower_bound(state.cursor);
+            for(; itr != results.end() && counter < maxrows; itr++, counter++) {
+                update_holdings(itr->user, &holdings::wins, itr->pkey, 1, itr->payouteos.amount);
+                state.cursor = itr->pkey + 1;
+                state.processed++;
+            }
+            if(itr != results.end())
+                return false;
+
+            auto scopeItr = scopes.upper_bound(state.cursor >> 32); //Next month
+            if(scopeItr == scopes.end())
+                return true;
+            state.cursor = scopeItr->yyyymm << 32;
+        }
+        return false;
+    }
+
+    //Every field of the checkpoint row equals the treasure row
+    static bool is_copy(const checkpoint& c, const treasure& t) {
+        return c.pkey == t.pkey && c.owner == t.owner && c.title == t.title && c.description == t.description
+            && c.imageurl == t.imageurl && c.treasuremapurl == t.treasuremapurl && c.videourl == t.videourl
+            && c.latitude == t.latitude && c.longitude == t.longitude && c.tileidxy == t.tileidxy
+            && c.rankingpoint == t.rankingpoint && c.timestamp == t.timestamp && c.expirationdate == t.expirationdate
+            && c.secretcode == t.secretcode && c.status == t.status && c.banditalarms == t.banditalarms
+            && c.noOfCaptures == t.noOfCaptures && c.ctypeid == t.ctypeid && c.conqueredby == t.conqueredby
+            && c.conqueredimg == t.conqueredimg && c.jsondata == t.jsondata;
+    }
+
+    //The first checkpoint on a map tile gets the land
+    void migrate_land(const treasure& t) {
+        land_index& lands = tables.lands();
+        uint64_t tileKey = maptile::tilekey(t.latitude, t.longitude, maptile::landZoom);
+        if(lands.find(tileKey) == lands.end()){
+            lands.emplace(_self, [&]( auto& row ) {
+                row.tilekey = tileKey;
+                row.owner = t.owner;
+                row.treasurepkey = t.pkey;
+            });
+            reindex_treasure(t.pkey, treasurestate{}, treasurestate{t.status == "active", t.latitude, t.longitude, t.rankingpoint});
+        }
+    }
+    //-----------------------------------------------------------------------------------------------------
+
+    //Shared by the single and batch admin updates on treasure
+    void set_ctypeid(treasure_index& treasures, treasure_index::const_iterator iterator, uint64_t cTypeId) {
+        treasurestate before = get_treasurestate(*iterator);
+
+        if(cTypeId == 0 ){ //Everything OK - Checkpoint NFT Challenge is active and in normal operation
+            treasures.modify(iterator, _self, [&]( auto& row ) {
+                row.status = "active";
+                row.ctypeid = cTypeId;
+                row.banditalarms = 0;
+                row.expirationdate = now() + 94608000; //Treasure ownership renewed for three years
+            });
+        }
+        else if(cTypeId >= 1 && cTypeId < 10){
+            treasures.modify(iterator, _self, [&]( auto& row ) {
+                row.status = "active";
+                row.ctypeid = cTypeId;
+                row.expirationdate = now() + 94608000; //Treasure ownership renewed for three years
+            });
+        }
+        else if(cTypeId == 90){ //
+            //Checkpoint has Bandit Alarms that has not been fixed within 30 days. Set as inactive and expired.
+            treasures.modify(iterator, _self, [&]( auto& row ) {
+                row.status = "inactive";
+                row.ctypeid = cTypeId;
+                row.banditalarms = row.banditalarms + 1;
+                row.expirationdate = now(); //Expires now. Owner has already had 30 days to fix it.
+            });
+        }
+        else if(cTypeId == 91){ //
+            //91: Same secret code has been used more than ten times. 
+            //Set checkpoint as inactive and to expire after 30 days
+            treasures.modify(iterator, _self, [&]( auto& row ) {
+                row.status = "inactive";
+                row.ctypeid = cTypeId;
+                row.expirationdate = now() + 2592000; //Expires after 30 days if secret code is not replaced
+            });
+        }
+        else if(cTypeId >= 92 && cTypeId < 100){ //Checkpoint NFT Challenge is inactive for other reasons and not in normal operation
+            treasures.modify(iterator, _self, [&]( auto& row ) {
+                row.status = "inactive";
+                row.ctypeid = cTypeId;
+            });
+        }
+        else{
+            treasures.modify(iterator, _self, [&]( auto& row ) {
+                row.ctypeid = cTypeId;
+            });
+        }
+        reindex_treasure(iterator->pkey, before, get_treasurestate(*iterator));
+    }
+
+    void set_ranking(treasure_index& treasures, treasure_index::const_iterator iterator, uint64_t rankingPoints) {
+        treasurestate before = get_treasurestate(*iterator);
+        treasures.modify(iterator, _self, [&]( auto& row ) {
+            row.rankingpoint = rankingPoints;
+        });
+        reindex_treasure(iterator->pkey, before, get_treasurestate(*iterator));
+    }
+
+    void set_expirationdate(treasure_index& treasures, treasure_index::const_iterator iterator, name payer, uint64_t expirationDate) {
+        treasures.modify(iterator, payer, [&]( auto& row ) {
+            row.expirationdate = expirationDate;
+        });
+    }
+
+    //Run update on each (pkey, value) in pkey order. Close pkeys are reached by stepping the iterator
+    //instead of a new lookup.
+    template<typename F>
+    void for_each_treasure(treasure_index& treasures, std::vector<std::pair<uint64_t, uint64_t>>& updates, F update) {
+        eosio_assert(updates.size() <= getMaxBatchSize(), "Too many updates in one action (see setting maxbatch).");
+        std::sort(updates.begin(), updates.end());
+
+        auto iterator = treasures.end();
+        for(const auto& item : updates) {
+            int steps = 0;
+            while(iterator != treasures.end() && iterator->pkey < item.first && steps < 4) {
+                iterator++;
+                steps++;
+            }
+            if(iterator == treasures.end() || iterator->pkey != item.first)
+                iterator = treasures.find(item.first);
+            eosio_assert(iterator != treasures.end(), "Treasure not found");
+            TELEMETRY_ADD(rowsread, 1);
+            TELEMETRY_ADD(rowswritten, 1);
+            update(iterator, item.second);
+        }
+    }
+
+    //What the map indexes know about a checkpoint. Only active checkpoints with land are counted.
+    struct treasurestate {
+        bool counted = false;
+        double latitude = 0;
+        double longitude = 0;
+        uint64_t rankingpoint = 0;
+    };
+
+    treasurestate get_treasurestate(const treasure& t) {
+        land_index& lands = tables.lands();
+        TELEMETRY_ADD(rowsread, 1);
+        return treasurestate{t.status == "active" && find_land(lands, t) != lands.end(), t.latitude, t.longitude, t.rankingpoint};
+    }
+
+    //Update the map indexes after a checkpoint has been minted, moved, changed status or ranking, or removed
+    void reindex_treasure(uint64_t pkey, const treasurestate& before, const treasurestate& after) {
+        if(before.counted == after.counted && before.latitude == after.latitude && before.longitude == after.longitude 
+           && before.rankingpoint == after.rankingpoint)
+            return;
+
+        uint64_t weightBefore = before.counted ? before.rankingpoint : 0;
+        uint64_t weightAfter = after.counted ? after.rankingpoint : 0;
+        if(weightBefore != weightAfter)
+            fenwick_add(pkey, (int64_t)weightAfter - (int64_t)weightBefore);
+
+        for(int zoom : maptile::clusterZooms) {
+            uint64_t beforeKey = maptile::tilekey(before.latitude, before.longitude, zoom);
+            uint64_t afterKey = maptile::tilekey(after.latitude, after.longitude, zoom);
+            if(before.counted && after.counted && beforeKey == afterKey){
+                update_tileagg(zoom, afterKey, pkey, 0, (int64_t)after.rankingpoint - (int64_t)before.rankingpoint);
+            }
+            else{
+                if(before.counted)
+                    update_tileagg(zoom, beforeKey, pkey, -1, -(int64_t)before.rankingpoint);
+                if(after.counted)
+                    update_tileagg(zoom, afterKey, pkey, 1, (int64_t)after.rankingpoint);
+            }
+        }
+    }
+
+    void update_tileagg(int zoom, uint64_t tileKey, uint64_t pkey, int64_t countDelta, int64_t rankDelta) {
+        tileagg_index tileaggs(_self, zoom);
+        auto itr = tileaggs.find(tileKey);
+        TELEMETRY_ADD(rowsread, 1);
+        TELEMETRY_ADD(rowswritten, 1);
+        if(itr == tileaggs.end()){
+            eosio_assert(countDelta > 0, "Map tile aggregate not found.");
+            tileaggs.emplace(_self, [&]( auto& row ) {
+                row.tilekey = tileKey;
+                row.activecount = countDelta;
+                row.rankingpoints = rankDelta;
+                row.reppkey = pkey;
+            });
+        }
+        else if((int64_t)itr->activecount + countDelta <= 0){
+            tileaggs.erase(itr);
+        }
+        else{
+            uint64_t reppkey = itr->reppkey;
+            if(countDelta < 0 && reppkey == pkey)
+                reppkey = find_reppkey(zoom, tileKey, pkey);
+
+            tileaggs.modify(itr, _self, [&]( auto& row ) {
+                row.activecount += countDelta;
+                row.rankingpoints += rankDelta;
+                row.reppkey = reppkey;
+            });
+        }
+    }
+
+    //Another checkpoint in the tile to represent the cluster, active if possible. 0 if the first 25 lands in the tile
+    //have no other checkpoint. All land in a tile is one continuous range of tile keys.
+    uint64_t find_reppkey(int zoom, uint64_t tileKey, uint64_t excludePkey) {
+        int shift = 2 * (maptile::landZoom - zoom);
+        uint64_t endKey = (tileKey + 1) << shift;
+        bool hasFallback = false;
+        uint64_t fallbackPkey = 0;
+        land_index& lands = tables.lands();
+        treasure_index& treasures = tables.treasures();
+        auto itr = lands.lower_bound(tileKey << shift);
+        for(int counter = 0; itr != lands.end() && itr->tilekey < endKey && counter < 25; itr++, counter++) {
+            TELEMETRY_ADD(rowsread, 2);
+            if(itr->treasurepkey == excludePkey)
+                continue;
+            if(!hasFallback){
+                hasFallback = true;
+                fallbackPkey = itr->treasurepkey;
+            }
+
+            auto treasureItr = treasures.find(itr->treasurepkey);
+            if(treasureItr != treasures.end() && treasureItr->status == "active")
+                return itr->treasurepkey;
+        }
+        return fallbackPkey;
+    }
+
+    void add_chestalloc(uint64_t treasurepkey, asset amount, name source, uint64_t sourcepkey) {
+        chestalloc_index& chestallocs = tables.chestallocs();
+        chestallocs.emplace(_self, [&]( auto& row ) {
+            row.pkey = chestallocs.available_primary_key();
+            row.treasurepkey = treasurepkey;
+            row.amount = amount;
+            row.source = source;
+            row.sourcepkey = sourcepkey;
+            row.timestamp = now();
+        });
+        TELEMETRY_ADD(rowswritten, 1);
+    }
+
+    //Fenwick tree (binary indexed tree) over checkpoint weights. Node i (1..capacity) is stored in page i / 64,
+    //the weight of checkpoint pkey is at position pkey + 1.
+    static constexpr uint64_t fenwickPageSize = 64;
+
+    uint64_t fenwick_get(fenwick_index& pages, uint64_t idx) {
+        auto itr = pages.find(idx / fenwickPageSize);
+        TELEMETRY_ADD(rowsread, 1);
+        return itr == pages.end() ? 0 : itr->sums[idx % fenwickPageSize];
+    }
+
+    void fenwick_add(uint64_t pkey, int64_t delta) {
+        seedcommit_singleton seedcommits(_self, _self.value);
+        TELEMETRY_ADD(rowsread, 1);
+        eosio_assert(!seedcommits.exists(), "Checkpoint weights are locked until the committed seed is revealed.");
+
+        fenwickcfg_singleton fenwickcfg(_self, _self.value);
+        auto cfg = fenwickcfg.get_or_default();
+        fenwick_index& pages = tables.fenwick();
+        uint64_t idx = pkey + 1;
+
+        if(cfg.capacity == 0){
+            cfg.capacity = fenwickPageSize;
+            fenwickcfg.set(cfg, _self);
+        }
+        if(idx > cfg.capacity){
+            //Double the capacity. The new root node covers the old tree, all other new nodes cover empty positions.
+            while(idx > cfg.capacity){
+                add_fenwick_nodes(pages, cfg.capacity * 2, cfg.capacity * 2, fenwick_get(pages, cfg.capacity));
+                cfg.capacity *= 2;
+            }
+            fenwickcfg.set(cfg, _self);
+        }
+        add_fenwick_nodes(pages, idx, cfg.capacity, delta);
+    }
+
+    //Add delta to node idx and the nodes above it, up to capacity. One write per page.
+    void add_fenwick_nodes(fenwick_index& pages, uint64_t idx, uint64_t capacity, int64_t delta) {
+        while(idx <= capacity) {
+            uint64_t page = idx / fenwickPageSize;
+            auto itr = pages.find(page);
+            std::vector<uint64_t> sums = (itr == pages.end()) ? std::vector<uint64_t>(fenwickPageSize, 0) : itr->sums;
+            for(; idx <= capacity && idx / fenwickPageSize == page; idx += idx & (~idx + 1))
+                sums[idx % fenwickPageSize] += delta;
+
+            TELEMETRY_ADD(rowsread, 1);
+            TELEMETRY_ADD(rowswritten, 1);
+            if(itr == pages.end()){
+                pages.emplace(_self, [&]( auto& row ) {
+                    row.page = page;
+                    row.sums = sums;
+                });
+            }
+            else{
+                pages.modify(itr, _self, [&]( auto& row ) {
+                    row.sums = sums;
+                });
+            }
+        }
+    }
+
+    //Weighted random checkpoint. Each active checkpoint with land is drawn with probability rankingpoint / total.
+    //drawNo must differ between draws with the same seed. Returns false if no checkpoint has any weight.
+    bool draw_treasure(const std::string& seed, uint64_t drawNo, uint64_t& treasurepkey) {
+        fenwickcfg_singleton fenwickcfg(_self, _self.value);
+        auto cfg = fenwickcfg.get_or_default();
+        if(cfg.capacity == 0)
+            return false;
+
+        fenwick_index& pages = tables.fenwick();
+        uint64_t total = fenwick_get(pages, cfg.capacity);
+        if(total == 0)
+            return false;
+
+        uint64_t target = draw_entropy(seed, drawNo) % total;
+        cfg.draws++;
+        fenwickcfg.set(cfg, _self);
+
+        //Find the smallest position where the prefix sum is larger than target
+        uint64_t pos = 0;
+        for(uint64_t step = cfg.capacity; step > 0; step >>= 1) {
+            if(pos + step <= cfg.capacity){
+                uint64_t nodeSum = fenwick_get(pages, pos + step);
+                if(nodeSum <= target){
+                    pos += step;
+                    target -= nodeSum;
+                }
+            }
+        }
+        treasurepkey = pos; //Position pos + 1 holds checkpoint pkey pos
+        return true;
+    }
+
+    //Check seed against the hash committed by commitseed and remove the commit, so each seed is used once
+    seedcommit reveal_seed(const std::string& seed) {
+        seedcommit_singleton seedcommits(_self, _self.value);
+        eosio_assert(seedcommits.exists(), "No seed committed.");
+        seedcommit commit = seedcommits.get();
+        eosio::assert_sha256(seed.c_str(), seed.length(), commit.seedhash);
+        seedcommits.remove();
+        return commit;
+    }
+
+    //Random number from the seed and a draw number. Nothing from the calling transaction is mixed in, so the
+    //result is fixed once the seed is.
+    uint64_t draw_entropy(const std::string& seed, uint64_t drawNo) {
+        std::vector<char> buffer(seed.length() + sizeof(drawNo));
+        std::copy(seed.begin(), seed.end(), buffer.begin());
+        memcpy(buffer.data() + seed.length(), &drawNo, sizeof(drawNo));
+
+        auto hash = eosio::sha256(buffer.data(), buffer.size()).extract_as_byte_array();
+        uint64_t random = 0;
+        for(int i = 0; i < 8; i++)
+            random = (random << 8) | hash[i];
+        return random;
+    }
+
+    //Inline transfer from this contract. contract is eosio.token for EOS or cptblackbill for BLKBILL
+    void send_transfer(name contract, name to, asset quantity, const memo_buffer& memo) {
+        action(
+            permission_level{ get_self(), "active"_n },
+            contract, "transfer"_n,
+            std::make_tuple(get_self(), to, quantity, memo)
+        ).send();
+        TELEMETRY_ADD(inlineactions, 1);
+    }
+
+    //History rows (results, exchngbuylog, dimndhistory, raceresults) are sent as log actions (logunlock, logfill,
+    //logrelocate, logracecp) instead of stored when the setting "historylog" has uintvalue 1. Sets row.pkey.
+    //Logged rows continue the pkeys of the stored rows, so pkeys don't repeat when the setting is changed.
+    //historyseq is only read once the setting exists. Until then every row is stored.
+    template<typename T, typename Table>
+    void add_history(Table& table, uint64_t historyseq::* next, name logaction, T& row) {
+        historylog mode = getHistoryLog();
+        row.pkey = table.available_primary_key();
+        TELEMETRY_ADD(rowsread, 1);
+        if(mode == historyNeverLogged){
+            store_history(table, logaction, row, false);
+            return;
+        }
+
+        historyseq_singleton seqs(_self, _self.value);
+        historyseq seq = seqs.get_or_default();
+        row.pkey = std::max(seq.*next, row.pkey);
+        TELEMETRY_ADD(rowsread, 1);
+
+        if(!store_history(table, logaction, row, mode == historyLogged)){
+            seq.*next = row.pkey + 1;
+            seqs.set(seq, _self);
+            TELEMETRY_ADD(rowswritten, 1);
+        }
+    }
+
+    //Store the history row (pkey already set), or send it as log action if logged. Returns true if the row was stored.
+    template<typename T, typename Table>
+    bool store_history(Table& table, name logaction, const T& row, bool logged) {
+        if(logged){
+            action(
+                permission_level{ get_self(), "active"_n },
+                get_self(), logaction,
+                std::make_tuple(row)
+            ).send();
+            TELEMETRY_ADD(inlineactions, 1);
+            return false;
+        }
+
+        table.emplace(_self, [&]( auto& r ) {
+            r = row;
+        });
+        TELEMETRY_ADD(rowswritten, 1);
+        TELEMETRY_ADD(bytesemplaced, eosio::pack_size(row));
+        return true;
+    }
+
+    //---Results by month----------------------------------------------------------------------------------
+    //Results are scoped by the month they are added (yyyymm of now()) and the months are listed in
+    //resultscope. pkey is (yyyymm << 32) + number within the month, so the scope of a result is known from its
+    //pkey. Results stored before the monthly scopes are in scope _self and have pkeys below 2^32.
+    uint64_t result_scope(uint64_t pkey) {
+        return (pkey >> 32) > 0 ? (pkey >> 32) : _self.value;
+    }
+
+    //Erase up to maxrows results of a month and mark it retired, so its pkeys are never used again. Returns the
+    //number of erased results.
+    uint32_t drop_month(resultscope_index& scopes, resultscope_index::const_iterator scopeItr, uint32_t maxrows) {
+        results_index results(_self, scopeItr->yyyymm);
+        uint32_t erased = 0;
+        for(auto itr = results.begin(); itr != results.end() && erased < maxrows; erased++) {
+            update_holdings(itr->user, &holdings::wins, itr->pkey, -1, -itr->payouteos.amount);
+            itr = results.erase(itr);
+        }
+        TELEMETRY_ADD(rowsread, erased);
+        TELEMETRY_ADD(rowswritten, erased);
+
+        scopes.modify(scopeItr, same_payer, [&]( auto& row ) {
+            row.rows -= erased;
+            row.retired = true;
+        });
+        TELEMETRY_ADD(rowswritten, 1);
+        return erased;
+    }
+
+    //Returns true if the result was stored, false if it was sent as log action
+    bool add_result(results& result) {
+        uint64_t month = calendar::yyyymm(now()); //Month the result is added. result.timestamp can be set by the caller
+        resultscope_index& scopes = tables.resultscopes();
+        auto scopeItr = scopes.find(month);
+        if(scopeItr == scopes.end()){
+            scopeItr = scopes.emplace(_self, [&]( auto& row ) {
+                row.yyyymm = month;
+                row.nextpkey = month << 32;
+                row.rows = 0;
+                row.retired = false;
+            });
+            TELEMETRY_ADD(rowswritten, 1);
+        }
+        eosio_assert(!scopeItr->retired, "Results for this month are retired.");
+        TELEMETRY_ADD(rowsread, 1);
+
+        result.pkey = scopeItr->nextpkey;
+        results_index results(_self, month);
+        bool stored = store_history(results, "logunlock"_n, result, getHistoryLog() == historyLogged);
+        scopes.modify(scopeItr, same_payer, [&]( auto& row ) {
+            row.nextpkey++;
+            if(stored)
+                row.rows++;
+        });
+        TELEMETRY_ADD(rowswritten, 1);
+        return stored;
+    }
+
     //---Get dapp settings---------------------------------------------------------------------------------
     asset getEosUsdPrice() {
         asset eosusd = eosio::asset(0, symbol(symbol_code("USD"), 4)); //default value
         
         //Get settings from table if exists. If not, default value is used
-        settings_index settings(_self, _self.value);
+        settings_index& settings = tables.settings();
         auto iterator = settings.find(name("eosusd").value); 
         if(iterator != settings.end()){
             eosusd = iterator->assetvalue;    
         }
+        TELEMETRY_ADD(rowsread, 1);
         return eosusd;
     };
     
@@ -3001,14 +4475,39 @@ private:
         asset eosusd = eosio::asset(27600, symbol(symbol_code("USD"), 4)); //default value
         
         //Get settings from table if exists. If not, default value is used
-        settings_index settings(_self, _self.value);
+        settings_index& settings = tables.settings();
         auto iterator = settings.find(name("eosusd").value); 
         if(iterator != settings.end()){
             eosusd = iterator->assetvalue;    
         }
+        TELEMETRY_ADD(rowsread, 1);
                  
-        uint64_t priceUSD = (eos.amount * eosusd.amount) / 10000;
-        return eosio::asset(priceUSD, symbol(symbol_code("USD"), 4));
+        return money::eos_to_usd(eos, eosusd);
+    };
+
+    //Setting "historylog": uintvalue 1 sends history as log actions, other values store it
+    enum historylog { historyNeverLogged, historyStored, historyLogged };
+
+    historylog getHistoryLog() {
+        settings_index& settings = tables.settings();
+        auto iterator = settings.find(name("historylog").value); 
+        TELEMETRY_ADD(rowsread, 1);
+        if(iterator == settings.end())
+            return historyNeverLogged;
+        return iterator->uintvalue == 1 ? historyLogged : historyStored;
+    };
+
+    uint32_t getMaxBatchSize() {
+        uint32_t maxBatchSize = 200; //default value
+
+        //Get settings from table if exists. If not, default value is used
+        settings_index& settings = tables.settings();
+        auto iterator = settings.find(name("maxbatch").value); 
+        if(iterator != settings.end()){
+            maxBatchSize = iterator->uintvalue;    
+        }
+        TELEMETRY_ADD(rowsread, 1);
+        return maxBatchSize;
     };
 
     asset getPriceForCheckTreasureValueInEOS() {
@@ -3016,20 +4515,19 @@ private:
         asset priceForCheckingTreasureValueInUSD = eosio::asset(20000, symbol(symbol_code("USD"), 4)); //default value for checking a treasure chest value
         
         //Get settings from table if exists. If not, default value is used
-        settings_index settings(_self, _self.value);
+        settings_index& settings = tables.settings();
         auto iterator = settings.find(name("eosusd").value); 
         if(iterator != settings.end()){
             eosusd = iterator->assetvalue;    
         }
+        TELEMETRY_ADD(rowsread, 1);
         
         auto iterator2 = settings.find(name("checktreasur").value); 
         if(iterator2 != settings.end()){
             priceForCheckingTreasureValueInUSD = iterator2->assetvalue;    
         }
         
-        double dblPriceInEOS = (priceForCheckingTreasureValueInUSD.amount * 10000) / eosusd.amount;
-        uint64_t priceInEOS = (uint64_t)dblPriceInEOS;   
-        //asset cptbbPrice = eosio::asset(priceInEOS, symbol(symbol_code("EOS"), 4));
+        asset priceInEOS = money::usd_to_eos(priceForCheckingTreasureValueInUSD, eosusd);
         
         //For debugging
         /*settings_index settingsdebug(_self, _self.value);
@@ -3039,11 +4537,11 @@ private:
         settingsdebug.modify(iterator3, _self, [&]( auto& row ) {
             row.stringvalue = "test2";
             row.assetvalue = cptbbPrice; //cptbbPrice;
-            row.uintvalue = priceInEOS; //eosusd.amount; //priceInEOS;
+            row.uintvalue = priceInEOS.amount; //eosusd.amount; //priceInEOS;
             row.timestamp = now();
         }); */
         
-        return eosio::asset(priceInEOS, symbol(symbol_code("EOS"), 4));
+        return priceInEOS;
     };
     //-----------------------------------------------------------------------------------------------------
 
@@ -3069,155 +4567,222 @@ private:
 
 extern "C" {
   void apply(uint64_t receiver, uint64_t code, uint64_t action) {
-    auto self = receiver;
-    //cptblackbill _cptblackbill(receiver);
-    //if(code==receiver && action==name("addtreasure").value) {
-    //  execute_action(name(receiver), name(code), &cptblackbill::addtreasure );
-    //}
-    if(code==receiver && action==name("btulla").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::btulla );
-    }
-    else if(code==receiver && action==name("calcdmndprov").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::calcdmndprov );
-    }
-    else if(code==receiver && action==name("prepdmndprov").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::prepdmndprov );
-    }
-    else if(code==receiver && action==name("payout").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::payout );
-    }
-    else if(code==receiver && action==name("addteammbr").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::addteammbr );
-    }
-    else if(code==receiver && action==name("delteammbr").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::delteammbr );
-    }
-    else if(code==receiver && action==name("addtradmin").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::addtradmin );
-    }
-    else if(code==receiver && action==name("addsellprice").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::addsellprice );
-    }
-    else if(code==receiver && action==name("delsellprice").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::delsellprice );
-    }
-    else if(code==receiver && action==name("airdrop").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::airdrop );
-    }
-    else if(code==receiver && action==name("addlike").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::addlike );
-    }
-    else if(code==receiver && action==name("eraselike").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::eraselike );
-    }
-    else if(code==receiver && action==name("modtreasure").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modtreasure );
-    }
-    else if(code==receiver && action==name("exechestfnd").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::exechestfnd );
-    }
-    else if(code==receiver && action==name("modrace").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modrace );
-    }
-    else if(code==receiver && action==name("modtreasimg").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modtreasimg );
-    }
-    else if(code==receiver && action==name("moddmndval").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::moddmndval );
-    }
-    else if(code==receiver && action==name("modgps").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modgps );
-    }
-    else if(code==receiver && action==name("modtreasjson").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modtreasjson );
-    }
-    else if(code==receiver && action==name("modsecretcode").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modsecretcode );
-    }
-    else if(code==receiver && action==name("activatchest").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::activatchest );
-    }
-    else if(code==receiver && action==name("modctypeid").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modctypeid );
-    }
-    else if(code==receiver && action==name("updranking").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::updranking );
-    }
-    else if(code==receiver && action==name("awardpayout").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::awardpayout );
-    }
-    else if(code==receiver && action==name("modexpdate").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modexpdate );
-    }
-    else if(code==receiver && action==name("resetsecretc").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::resetsecretc );
-    }
-    else if(code==receiver && action==name("unlockchest").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::unlockchest );
-    }
-    else if(code==receiver && action==name("unlocktest").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::unlocktest );
-    }
-    else if(code==receiver && action==name("erasetreasur").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::erasetreasur );
-    }
-    else if(code==receiver && action==name("erasesellord").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::erasesellord );
-    }
-    else if(code==receiver && action==name("addresult").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::addresult );
-    }
-    else if(code==receiver && action==name("addracerslt").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::addracerslt );
-    }
-    else if(code==receiver && action==name("clearacerslt").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::clearacerslt );
-    }
-    else if(code==receiver && action==name("delracersult").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::delracersult );
-    }
-    else if(code==receiver && action==name("addsetting").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::addsetting );
-    }
-    else if(code==receiver && action==name("modsetting").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::modsetting );
-    }
-    else if(code==receiver && action==name("moduawuser").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::moduawuser );
-    }
-    else if(code==receiver && action==name("erasesetting").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::erasesetting );
-    }
-    else if(code==receiver && action==name("eraseresult").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::eraseresult );
-    }
-    else if(code==receiver && action==name("clearresult").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::clearresult );
-    }
-    else if(code==receiver && action==name("upsertcrew").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::upsertcrew );
-    }
-    else if(code==receiver && action==name("erasecrew").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::erasecrew );
-    }
-    else if(code==receiver && action==name("adddimndhst").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::adddimndhst );
-    }
-    else if(code==receiver && action==name("addsponsitm").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::addsponsitm );
-    }
-    else if(code==receiver && action==name("erasesponitm").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::erasesponitm );
-    }
-    else if(code==receiver && action==name("issue").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::issue );
-    }
-    else if(code==receiver && action==name("transfer").value) {
-      execute_action(name(receiver), name(code), &cptblackbill::transfer );
-    }
-    else if(code==name("eosio.token").value && action==name("transfer").value) {
+    //Incoming eosio.token transfers (the most frequent call) are tested first. All other actions
+    //are dispatched by a switch on compile time name values (compiled to a jump table / binary search)
+    //instead of testing every action name in sequence.
+    if(code == "eosio.token"_n.value && action == "transfer"_n.value) {
       execute_action(name(receiver), name(code), &cptblackbill::onTransfer );
     }
+    else if(code == receiver) {
+      switch(action) {
+#ifdef CPTBB_DIAGNOSTICS
+        case "btulla"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::btulla );
+          break;
+        case "calcdmndprov"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::calcdmndprov );
+          break;
+        case "prepdmndprov"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::prepdmndprov );
+          break;
+        case "payout"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::payout );
+          break;
+#endif
+        case "addteammbr"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::addteammbr );
+          break;
+        case "delteammbr"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::delteammbr );
+          break;
+        case "addtradmin"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::addtradmin );
+          break;
+        case "addsellprice"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::addsellprice );
+          break;
+        case "delsellprice"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::delsellprice );
+          break;
+        case "airdrop"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::airdrop );
+          break;
+        case "addlike"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::addlike );
+          break;
+        case "eraselike"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::eraselike );
+          break;
+        case "modtreasure"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modtreasure );
+          break;
+        case "exechestfnd"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::exechestfnd );
+          break;
+        case "execchestbatch"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::execchestbatch );
+          break;
+        case "modrace"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modrace );
+          break;
+        case "modtreasimg"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modtreasimg );
+          break;
+        case "moddmndval"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::moddmndval );
+          break;
+        case "modgps"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modgps );
+          break;
+        case "modtreasjson"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modtreasjson );
+          break;
+        case "modsecretcode"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modsecretcode );
+          break;
+        case "activatchest"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::activatchest );
+          break;
+        case "modctypeid"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modctypeid );
+          break;
+        case "updrankings"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::updrankings );
+          break;
+        case "modctypeids"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modctypeids );
+          break;
+        case "modexpdates"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modexpdates );
+          break;
+        case "updranking"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::updranking );
+          break;
+        case "awardpayout"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::awardpayout );
+          break;
+        case "modexpdate"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modexpdate );
+          break;
+        case "resetsecretc"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::resetsecretc );
+          break;
+        case "unlockchest"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::unlockchest );
+          break;
+#ifdef CPTBB_DIAGNOSTICS
+        case "unlocktest"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::unlocktest );
+          break;
+        case "statehash"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::statehash );
+          break;
+#endif
+        case "erasetreasur"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::erasetreasur );
+          break;
+        case "startmigr"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::startmigr );
+          break;
+        case "migrate"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::migrate );
+          break;
+        case "viewport"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::viewport );
+          break;
+        case "nearby"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::nearby );
+          break;
+        case "portfolio"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::portfolio );
+          break;
+        case "standings"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::standings );
+          break;
+        case "erasesellord"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::erasesellord );
+          break;
+        case "addresult"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::addresult );
+          break;
+        case "addracerslt"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::addracerslt );
+          break;
+        case "clearacerslt"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::clearacerslt );
+          break;
+        case "delracersult"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::delracersult );
+          break;
+        case "delstandings"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::delstandings );
+          break;
+        case "addsetting"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::addsetting );
+          break;
+        case "modsetting"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::modsetting );
+          break;
+        case "moduawuser"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::moduawuser );
+          break;
+        case "erasesetting"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::erasesetting );
+          break;
+        case "eraseresult"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::eraseresult );
+          break;
+        case "dropmonth"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::dropmonth );
+          break;
+        case "logunlock"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::logunlock );
+          break;
+        case "logfill"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::logfill );
+          break;
+        case "logrelocate"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::logrelocate );
+          break;
+        case "logracecp"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::logracecp );
+          break;
+        case "clearresult"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::clearresult );
+          break;
+        case "upsertcrew"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::upsertcrew );
+          break;
+        case "erasecrew"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::erasecrew );
+          break;
+        case "adddimndhst"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::adddimndhst );
+          break;
+        case "commitseed"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::commitseed );
+          break;
+        case "drawchest"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::drawchest );
+          break;
+        case "addsponsitm"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::addsponsitm );
+          break;
+        case "erasesponitm"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::erasesponitm );
+          break;
+        case "issue"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::issue );
+          break;
+        case "transfer"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::transfer );
+          break;
+#ifdef CPTBB_TELEMETRY
+        case "gettelemetry"_n.value:
+          execute_action(name(receiver), name(code), &cptblackbill::gettelemetry );
+          break;
+#endif
+      }
+    }
   }
 };
-
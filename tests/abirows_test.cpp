@@ -0,0 +1,57 @@
+#include "test.hpp"
+#include "cptblackbill_rows.hpp"
+#include "packer.hpp"
+
+TEST(treasure_without_extension) {
+    packer p = packed_treasure(7, 0x1234, 59.91, 10.75, 1700000000, "Old fort");
+    auto t = abirows::decode_treasure_row(p.data.data(), p.data.size());
+    CHECK(t.pkey == 7);
+    CHECK(t.owner == 0x1234);
+    CHECK(t.title == "Old fort");
+    CHECK(t.latitude == 59.91);
+    CHECK(t.rankingpoint == 42);
+    CHECK(t.status == "active");
+    CHECK(t.jsondata == "{}");
+    CHECK(!t.latitudee7.has_value());
+    CHECK(!t.longitudee7.has_value());
+}
+
+TEST(treasure_with_extension) {
+    packer p = packed_treasure(8, 0x1234, 59.91, 10.75, 1700000000, "New fort");
+    p.fixed<int32_t>(599100000).fixed<int32_t>(107500000);
+    auto t = abirows::decode_treasure_row(p.data.data(), p.data.size());
+    CHECK(t.latitudee7.has_value() && *t.latitudee7 == 599100000);
+    CHECK(t.longitudee7.has_value() && *t.longitudee7 == 107500000);
+}
+
+TEST(strings_point_into_the_row) {
+    packer p = packed_treasure(9, 0x1234, 59.91, 10.75, 1700000000, "Zero copy");
+    auto t = abirows::decode_treasure_row(p.data.data(), p.data.size());
+    CHECK(t.title.data() >= p.data.data() && t.title.data() < p.data.data() + p.data.size());
+}
+
+TEST(nested_lists) {
+    packer p;
+    p.fixed<uint64_t>(0x99);
+    for(int list = 0; list < 5; list++) {
+        p.fixed<uint32_t>(list).fixed<int64_t>(-list).varuint32(list);
+        for(int i = 0; i < list; i++)
+            p.fixed<uint64_t>(100 + i);
+    }
+    auto h = abirows::decode_holdings_row(p.data.data(), p.data.size());
+    CHECK(h.account == 0x99);
+    CHECK(h.checkpoints.pkeys.empty());
+    CHECK(h.wins.count == 4);
+    CHECK(h.wins.total == -4);
+    CHECK(h.wins.pkeys.size() == 4 && h.wins.pkeys[3] == 103);
+}
+
+TEST(short_rows_throw) {
+    packer p = packed_treasure(10, 0x1234, 59.91, 10.75, 1700000000, "Cut");
+    CHECK_THROWS(abirows::decode_treasure_row(p.data.data(), p.data.size() - 1));
+    packer lengths;
+    lengths.fixed<uint64_t>(1).fixed<uint64_t>(2).varuint32(1000); //title longer than the row
+    CHECK_THROWS(abirows::decode_treasure_row(lengths.data.data(), lengths.data.size()));
+}
+
+TEST_MAIN()
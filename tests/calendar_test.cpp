@@ -0,0 +1,29 @@
+#include "test.hpp"
+#include "calendar.hpp"
+
+TEST(month_boundaries) {
+    CHECK(calendar::yyyymm(0) == 197001);
+    CHECK(calendar::yyyymm(1704067199) == 202312); //2023-12-31 23:59:59
+    CHECK(calendar::yyyymm(1704067200) == 202401); //2024-01-01 00:00:00
+    CHECK(calendar::yyyymm(1711929599) == 202403); //2024-03-31 23:59:59
+    CHECK(calendar::yyyymm(1711929600) == 202404); //2024-04-01 00:00:00
+}
+
+TEST(leap_years) {
+    CHECK(calendar::yyyymm(1709164800) == 202402); //2024-02-29 00:00:00
+    CHECK(calendar::yyyymm(1709251199) == 202402); //2024-02-29 23:59:59
+    CHECK(calendar::yyyymm(1709251200) == 202403); //2024-03-01 00:00:00
+    CHECK(calendar::yyyymm(1677628799) == 202302); //2023-02-28 23:59:59, no leap day
+    CHECK(calendar::yyyymm(1677628800) == 202303); //2023-03-01 00:00:00
+    CHECK(calendar::yyyymm(951782400) == 200002);  //2000-02-29 00:00:00, divisible by 400
+    CHECK(calendar::yyyymm(951868800) == 200003);  //2000-03-01 00:00:00
+    CHECK(calendar::yyyymm(4107542400) == 210003); //2100-03-01 00:00:00, no leap day in 2100
+    CHECK(calendar::yyyymm(4107542399) == 210002); //2100-02-28 23:59:59
+}
+
+TEST(int32_range) {
+    CHECK(calendar::yyyymm(2147483647) == 203801); //2038-01-19
+    CHECK(calendar::yyyymm(-1) == 196912);
+}
+
+TEST_MAIN()
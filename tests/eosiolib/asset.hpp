@@ -0,0 +1,49 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Host stand-in for eosio::symbol_code, eosio::symbol and eosio::asset (amount, symbol and max_amount).
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "system.hpp"
+
+namespace eosio {
+
+    class symbol_code {
+    public:
+        explicit symbol_code(uint64_t raw) : _value(raw) {}
+        explicit symbol_code(const std::string& text) {
+            eosio_assert(text.size() <= 7, "string is too long to be a valid symbol_code");
+            for(auto it = text.rbegin(); it != text.rend(); ++it)
+                _value = (_value << 8) | (uint8_t)*it;
+        }
+        uint64_t raw() const { return _value; }
+
+    private:
+        uint64_t _value = 0;
+    };
+
+    class symbol {
+    public:
+        symbol(symbol_code code, uint8_t precision) : _value((code.raw() << 8) | precision) {}
+        uint8_t precision() const { return (uint8_t)(_value & 0xFF); }
+        symbol_code code() const { return symbol_code(_value >> 8); }
+        bool operator==(const symbol& other) const { return _value == other._value; }
+
+    private:
+        uint64_t _value;
+    };
+
+    struct asset {
+        static constexpr int64_t max_amount = (1LL << 62) - 1;
+
+        int64_t amount = 0;
+        eosio::symbol symbol;
+
+        asset(int64_t a, eosio::symbol s) : amount(a), symbol(s) {}
+    };
+}
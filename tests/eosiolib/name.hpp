@@ -0,0 +1,40 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Host stand-in for eosio::name with the same base32 encoding as eosiolib.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include "system.hpp"
+
+namespace eosio {
+
+    struct name {
+        uint64_t value = 0;
+
+        name() = default;
+        explicit name(uint64_t v) : value(v) {}
+        explicit name(const std::string& text) {
+            eosio_assert(text.size() <= 13, "string is too long to be a valid name");
+            for(size_t i = 0; i < text.size() && i < 12; i++)
+                value |= (char_to_value(text[i]) & 0x1F) << (64 - 5 * (i + 1));
+            if(text.size() == 13)
+                value |= char_to_value(text[12]) & 0x0F;
+        }
+
+        static uint64_t char_to_value(char c) {
+            if(c == '.')
+                return 0;
+            if(c >= '1' && c <= '5')
+                return (c - '1') + 1;
+            if(c >= 'a' && c <= 'z')
+                return (c - 'a') + 6;
+            eosio_assert(false, "character is not in allowed character set for names");
+            return 0;
+        }
+    };
+}
@@ -0,0 +1,15 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Host stand-ins for the parts of eosiolib used by the plain headers under test (memo.hpp, money.hpp).
+ *  Only for tests: eosio_assert throws instead of aborting the transaction, so failures can be checked.
+ */
+#pragma once
+
+#include <stdexcept>
+
+inline void eosio_assert(bool condition, const char* message) {
+    if(!condition)
+        throw std::runtime_error(message);
+}
@@ -0,0 +1,17 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Host stand-in for eosio::unsigned_int (only the value is needed by the tests).
+ */
+#pragma once
+
+#include <cstdint>
+
+namespace eosio {
+
+    struct unsigned_int {
+        uint32_t value;
+        unsigned_int(uint32_t v = 0) : value(v) {}
+    };
+}
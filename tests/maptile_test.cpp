@@ -0,0 +1,67 @@
+#include "test.hpp"
+#include "maptile.hpp"
+
+#include <cstdint>
+
+TEST(morton_round_trip) {
+    const uint32_t values[] = {0, 1, 2, 3, 69447, 38120, 131071, 0x55555555, 0xAAAAAAAA, UINT32_MAX};
+    for(uint32_t x : values) {
+        for(uint32_t y : values) {
+            uint64_t key = maptile::morton(x, y);
+            CHECK(maptile::mortonx(key) == x);
+            CHECK(maptile::mortony(key) == y);
+        }
+    }
+    CHECK(maptile::morton(1, 0) == 1);
+    CHECK(maptile::morton(0, 1) == 2);
+    CHECK(maptile::morton(UINT32_MAX, UINT32_MAX) == UINT64_MAX);
+}
+
+TEST(tilekey_round_trip) {
+    //Oslo on the land zoom level
+    double latitude = 59.9138, longitude = 10.7522;
+    int zoom = maptile::landZoom;
+    uint64_t key = maptile::tilekey(latitude, longitude, zoom);
+    CHECK(maptile::mortonx(key) == (uint32_t)maptile::tilex(longitude, zoom));
+    CHECK(maptile::mortony(key) == (uint32_t)maptile::tiley(latitude, zoom));
+
+    //The parent key on every cluster zoom level is the key of the same point on that level
+    for(int clusterZoom : maptile::clusterZooms)
+        CHECK(maptile::parentkey(key, zoom, clusterZoom) == maptile::tilekey(latitude, longitude, clusterZoom));
+}
+
+TEST(clamptile_edges) {
+    int zoom = maptile::landZoom;
+    uint32_t last = (1u << zoom) - 1;
+    CHECK(maptile::clamptile(-1, zoom) == 0);
+    CHECK(maptile::clamptile(0, zoom) == 0);
+    CHECK(maptile::clamptile((int)last, zoom) == last);
+    CHECK(maptile::clamptile((int)last + 1, zoom) == last);
+    CHECK(maptile::clamptile(0, 0) == 0);
+    CHECK(maptile::clamptile(1, 0) == 0);
+
+    //Latitudes beyond the map edge and the date line land on the edge tiles
+    CHECK(maptile::mortony(maptile::tilekey(89.9, 0, zoom)) == 0);
+    CHECK(maptile::mortony(maptile::tilekey(-89.9, 0, zoom)) == last);
+    CHECK(maptile::mortonx(maptile::tilekey(0, -180, zoom)) == 0);
+    CHECK(maptile::mortonx(maptile::tilekey(0, 180, zoom)) == last);
+}
+
+TEST(tileidxy_legacy_format) {
+    CHECK(maptile::tileidxy(69447, 38120) == 69447.38120);
+    CHECK(maptile::tileidxy(5, 7) == 5.7);
+}
+
+TEST(fixedcoord_rounding) {
+    CHECK(maptile::fixedcoord(59.9138) == 599138000);
+    CHECK(maptile::fixedcoord(-10.7522) == -107522000);
+    CHECK(maptile::fixedcoord(0.00000005) == 1);
+}
+
+TEST(stringtodouble_memo_coordinates) {
+    CHECK(maptile::fixedcoord(maptile::stringtodouble("59.9138")) == 599138000);
+    CHECK(maptile::fixedcoord(maptile::stringtodouble("-10.7522")) == -107522000);
+    CHECK(maptile::fixedcoord(maptile::stringtodouble("0.5")) == 5000000);
+}
+
+TEST_MAIN()
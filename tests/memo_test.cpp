@@ -0,0 +1,58 @@
+#include "test.hpp"
+#include "memo.hpp"
+
+#include <string>
+
+static std::string text(const memo_buffer& memo) {
+    return std::string(memo.data(), memo.size());
+}
+
+static eosio::symbol eos_symbol() {
+    return eosio::symbol(eosio::symbol_code("EOS"), 4);
+}
+
+TEST(integers) {
+    CHECK(text(memo_buffer() << (uint64_t)0) == "0");
+    CHECK(text(memo_buffer() << (uint64_t)UINT64_MAX) == "18446744073709551615");
+    CHECK(text(memo_buffer() << (int64_t)INT64_MIN) == "-9223372036854775808");
+    CHECK(text(memo_buffer() << (int32_t)-42 << ' ' << (uint32_t)42) == "-42 42");
+    CHECK(text(memo_buffer() << "Treasure No." << (uint64_t)123 << ".") == "Treasure No.123.");
+}
+
+TEST(fixed_point) {
+    CHECK(text(memo_buffer() << memo_buffer::fixed(12345, 4)) == "1.2345");
+    CHECK(text(memo_buffer() << memo_buffer::fixed(5, 4)) == "0.0005");
+    CHECK(text(memo_buffer() << memo_buffer::fixed(-5, 4)) == "-0.0005");
+    CHECK(text(memo_buffer() << memo_buffer::fixed(120000, 4)) == "12.0000");
+    CHECK(text(memo_buffer() << memo_buffer::fixed(7, 0)) == "7");
+}
+
+TEST(asset_formatting) {
+    CHECK(text(memo_buffer() << eosio::asset(123456, eos_symbol())) == "12.3456 EOS");
+    CHECK(text(memo_buffer() << eosio::asset(-1, eos_symbol())) == "-0.0001 EOS");
+    CHECK(text(memo_buffer() << eosio::asset(10000, eosio::symbol(eosio::symbol_code("BLKBILL"), 4))) == "1.0000 BLKBILL");
+}
+
+TEST(name_formatting) {
+    CHECK(text(memo_buffer() << eosio::name("cptblackbill")) == "cptblackbill");
+    CHECK(text(memo_buffer() << eosio::name("eosio.token")) == "eosio.token");
+    CHECK(text(memo_buffer() << eosio::name("a")) == "a");
+    CHECK(text(memo_buffer() << eosio::name("tldsharehldr")) == "tldsharehldr");
+    CHECK(text(memo_buffer() << eosio::name()) == "");
+}
+
+TEST(truncates_at_max_size) {
+    memo_buffer memo;
+    for(int i = 0; i < 300; i++)
+        memo << 'x';
+    CHECK(memo.size() == memo_buffer::max_size);
+
+    //Numbers and text stop at the limit without writing past the buffer
+    memo_buffer longText;
+    std::string chunk(250, 'y');
+    longText << chunk.c_str() << (uint64_t)1234567890 << eosio::asset(123456, eos_symbol());
+    CHECK(longText.size() == memo_buffer::max_size);
+    CHECK(text(longText) == chunk + "123456");
+}
+
+TEST_MAIN()
@@ -0,0 +1,66 @@
+#include "test.hpp"
+#include "money.hpp"
+
+static eosio::asset eos(int64_t amount) {
+    return eosio::asset(amount, eosio::symbol(eosio::symbol_code("EOS"), 4));
+}
+
+TEST(muldiv_rounds_down) {
+    CHECK(money::muldiv(10, 3, 4) == 7);
+    CHECK(money::muldiv(-10, 3, 4) == -7);
+    CHECK(money::muldiv(1, 1, 3) == 0);
+}
+
+TEST(muldiv_wide_intermediate) {
+    //The product is far above int64 but the result fits
+    int64_t big = eosio::asset::max_amount;
+    CHECK(money::muldiv(big, 10000, 10000) == big);
+    CHECK(money::muldiv(big, big, big) == big);
+}
+
+TEST(muldiv_overflow_and_division_by_zero) {
+    int64_t big = eosio::asset::max_amount;
+    CHECK_THROWS(money::muldiv(big, 2, 1));
+    CHECK_THROWS(money::muldiv(-big, 2, 1));
+    CHECK_THROWS(money::muldiv(1, 1, 0));
+}
+
+TEST(checked_applies_to_final_amounts_only) {
+    //USD with 8 decimals: a huge price times a huge quantity is fine as an intermediate
+    money::wide usd = money::mul(eosio::asset::max_amount, 1000000);
+    CHECK_THROWS(money::checked(usd));
+    CHECK(money::checked(usd / 1000000) == eosio::asset::max_amount);
+}
+
+TEST(bps_parts) {
+    CHECK(money::bps(eos(10000), 250).amount == 250); //2.5 percent
+    CHECK(money::bps(eos(10000), 10000).amount == 10000);
+    CHECK(money::bps(eos(9), 1000).amount == 0);
+}
+
+TEST(bps_remainder_to_last_receiver) {
+    //Splits give the last receiver amount - parts, so the parts always add up to the amount
+    const int64_t amounts[] = {1, 3, 7, 9999, 10001, 123456789};
+    for(int64_t amount : amounts) {
+        eosio::asset total = eos(amount);
+        eosio::asset toTokenHolders = money::bps(total, 1000);
+        eosio::asset toDiamond = eosio::asset(total.amount - toTokenHolders.amount, total.symbol);
+        CHECK(toTokenHolders.amount + toDiamond.amount == amount);
+        CHECK(toDiamond.amount >= money::bps(total, 9000).amount);
+
+        eosio::asset finder = money::half(total);
+        eosio::asset creator = eosio::asset(total.amount - finder.amount, total.symbol);
+        CHECK(finder.amount + creator.amount == amount);
+        CHECK(creator.amount - finder.amount <= 1);
+    }
+}
+
+TEST(usd_eos_conversion) {
+    eosio::asset eosusd = eosio::asset(12345, eosio::symbol(eosio::symbol_code("USD"), 4)); //1 EOS = 1.2345 USD
+    eosio::asset usd = eosio::asset(24690, eosio::symbol(eosio::symbol_code("USD"), 4));
+    CHECK(money::usd_to_eos(usd, eosusd).amount == 20000);
+    CHECK(money::eos_to_usd(eos(20000), eosusd).amount == 24690);
+    CHECK_THROWS(money::usd_to_eos(usd, eosio::asset(0, eosusd.symbol)));
+}
+
+TEST_MAIN()
@@ -0,0 +1,47 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Builds packed table rows for the tests of the generated decoders.
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+//Packs values the way the contract stores them (little endian, varuint32 lengths)
+struct packer {
+    std::string data;
+
+    template<typename T>
+    packer& fixed(T value) {
+        data.append(reinterpret_cast<const char*>(&value), sizeof(T));
+        return *this;
+    }
+
+    packer& varuint32(uint32_t value) {
+        do {
+            uint8_t b = value & 0x7f;
+            value >>= 7;
+            fixed<uint8_t>(b | (value > 0 ? 0x80 : 0));
+        } while(value > 0);
+        return *this;
+    }
+
+    packer& str(const std::string& s) {
+        varuint32(s.size());
+        data += s;
+        return *this;
+    }
+};
+
+//treasure row without the layout 2 fields (latitudee7, longitudee7)
+inline packer packed_treasure(uint64_t pkey, uint64_t owner, double latitude, double longitude, int32_t timestamp,
+                              const std::string& title) {
+    packer p;
+    p.fixed<uint64_t>(pkey).fixed<uint64_t>(owner).str(title).str("description").str("img").str("map").str("video")
+     .fixed<double>(latitude).fixed<double>(longitude).fixed<double>(0).fixed<uint64_t>(42).fixed<int32_t>(timestamp)
+     .fixed<int32_t>(1800000000).str("secret").str("active").fixed<uint64_t>(1).fixed<uint64_t>(2).fixed<uint64_t>(0)
+     .fixed<uint64_t>(0).str("").str("{}");
+    return p;
+}
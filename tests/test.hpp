@@ -0,0 +1,71 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  Minimal host test runner. Each test file defines TEST(name) blocks; CHECK records a failure and
+ *  continues, main() returns the number of failed checks.
+ */
+#pragma once
+
+#include <cstdio>
+#include <functional>
+#include <vector>
+
+namespace test {
+
+    struct testcase {
+        const char* name;
+        std::function<void()> run;
+    };
+
+    inline std::vector<testcase>& registry() {
+        static std::vector<testcase> tests;
+        return tests;
+    }
+
+    inline int& failures() {
+        static int count = 0;
+        return count;
+    }
+
+    struct registrar {
+        registrar(const char* name, std::function<void()> run) { registry().push_back({name, run}); }
+    };
+}
+
+#define TEST_CONCAT2(a, b) a##b
+#define TEST_CONCAT(a, b) TEST_CONCAT2(a, b)
+
+#define TEST(name) \
+    static void name(); \
+    static test::registrar TEST_CONCAT(name, _registrar)(#name, name); \
+    static void name()
+
+#define CHECK(cond) \
+    do { \
+        if(!(cond)){ \
+            std::printf("%s:%d: CHECK(%s) failed\n", __FILE__, __LINE__, #cond); \
+            test::failures()++; \
+        } \
+    } while(0)
+
+//Expression must throw (eosio_assert throws in the host build of eosiolib, see tests/eosiolib)
+#define CHECK_THROWS(expr) \
+    do { \
+        bool thrown = false; \
+        try { (void)(expr); } catch(...) { thrown = true; } \
+        if(!thrown){ \
+            std::printf("%s:%d: CHECK_THROWS(%s) did not throw\n", __FILE__, __LINE__, #expr); \
+            test::failures()++; \
+        } \
+    } while(0)
+
+#define TEST_MAIN() \
+    int main() { \
+        for(auto& t : test::registry()) { \
+            int before = test::failures(); \
+            t.run(); \
+            std::printf("%s %s\n", test::failures() == before ? "ok  " : "FAIL", t.name); \
+        } \
+        return test::failures(); \
+    }
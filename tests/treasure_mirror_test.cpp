@@ -0,0 +1,68 @@
+#include "test.hpp"
+#include "packer.hpp"
+#include "indexer/treasure_mirror.hpp"
+
+#include <algorithm>
+
+static const uint64_t alice = 1;
+static const uint64_t bob = 2;
+
+static std::vector<uint64_t> sorted(std::vector<uint64_t> pkeys) {
+    std::sort(pkeys.begin(), pkeys.end());
+    return pkeys;
+}
+
+static indexer::treasure_mirror oslo_mirror() {
+    indexer::treasure_mirror mirror;
+    mirror.upsert(packed_treasure(1, alice, 59.9139, 10.7522, 100, "Oslo").data);
+    mirror.upsert(packed_treasure(2, alice, 59.9140, 10.7530, 200, "Oslo 2").data);
+    mirror.upsert(packed_treasure(3, bob, 60.3913, 5.3221, 300, "Bergen").data);
+    return mirror;
+}
+
+TEST(upsert_and_find) {
+    indexer::treasure_mirror mirror = oslo_mirror();
+    CHECK(mirror.size() == 3);
+    CHECK(mirror.find(3) != nullptr && mirror.find(3)->title == "Bergen");
+    CHECK(mirror.find(4) == nullptr);
+}
+
+TEST(owner_index) {
+    indexer::treasure_mirror mirror = oslo_mirror();
+    CHECK(sorted(mirror.by_owner(alice)) == std::vector<uint64_t>({1, 2}));
+    CHECK(mirror.by_owner(bob) == std::vector<uint64_t>({3}));
+}
+
+TEST(tile_index) {
+    indexer::treasure_mirror mirror = oslo_mirror();
+    CHECK(sorted(mirror.in_tile(maptile::tilekey(59.9139, 10.7522, 8), 8)) == std::vector<uint64_t>({1, 2}));
+    CHECK(mirror.in_tile(maptile::tilekey(60.3913, 5.3221, 14), 14) == std::vector<uint64_t>({3}));
+    CHECK(mirror.in_tile(maptile::tilekey(0, 0, 8), 8).empty());
+}
+
+TEST(time_index) {
+    indexer::treasure_mirror mirror = oslo_mirror();
+    CHECK(sorted(mirror.created_between(100, 300)) == std::vector<uint64_t>({1, 2}));
+    CHECK(mirror.created_between(301, 400).empty());
+}
+
+TEST(update_moves_index_keys) {
+    indexer::treasure_mirror mirror = oslo_mirror();
+    mirror.upsert(packed_treasure(1, bob, 60.3913, 5.3221, 100, "Moved").data); //Sold and moved to Bergen
+    CHECK(mirror.size() == 3);
+    CHECK(mirror.find(1)->title == "Moved");
+    CHECK(mirror.by_owner(alice) == std::vector<uint64_t>({2}));
+    CHECK(sorted(mirror.by_owner(bob)) == std::vector<uint64_t>({1, 3}));
+    CHECK(sorted(mirror.in_tile(maptile::tilekey(60.3913, 5.3221, 14), 14)) == std::vector<uint64_t>({1, 3}));
+}
+
+TEST(erase_removes_index_keys) {
+    indexer::treasure_mirror mirror = oslo_mirror();
+    mirror.erase(2);
+    mirror.erase(9); //Not mirrored
+    CHECK(mirror.size() == 2);
+    CHECK(mirror.by_owner(alice) == std::vector<uint64_t>({1}));
+    CHECK(mirror.created_between(200, 201).empty());
+}
+
+TEST_MAIN()
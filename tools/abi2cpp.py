@@ -0,0 +1,174 @@
+#!/usr/bin/env python3
+"""Generate C++ structs and binary decoders from an EOSIO ABI.
+
+    tools/abi2cpp.py cptblackbill.abi cptblackbill_rows.hpp
+
+Rows are decoded straight from the packed table data (get_table_rows with "json": false, or a state-history
+table delta). Strings, bytes and checksums are std::string_view into that data, so the data must outlive the
+decoded row. Binary extension fields (type$) are std::optional and empty when the row ends before them.
+"""
+import json
+import sys
+
+FIXED = {
+    'bool': 'bool', 'int8': 'int8_t', 'uint8': 'uint8_t', 'int16': 'int16_t', 'uint16': 'uint16_t',
+    'int32': 'int32_t', 'uint32': 'uint32_t', 'int64': 'int64_t', 'uint64': 'uint64_t',
+    'float32': 'float', 'float64': 'double', 'name': 'uint64_t', 'symbol': 'uint64_t', 'symbol_code': 'uint64_t',
+}
+
+def cpp_type(abitype):
+    if abitype.endswith('$') or abitype.endswith('?'):
+        return 'std::optional<%s>' % cpp_type(abitype[:-1])
+    if abitype.endswith('[]'):
+        return 'std::vector<%s>' % cpp_type(abitype[:-2])
+    if abitype in FIXED:
+        return FIXED[abitype]
+    if abitype in ('string', 'bytes', 'checksum256'):
+        return 'std::string_view'
+    if abitype == 'varuint32':
+        return 'uint32_t'
+    if abitype == 'asset':
+        return 'asset'
+    return abitype
+
+def read_expr(abitype):
+    if abitype.endswith('$'):
+        return 'r.more() ? %s(%s) : std::nullopt' % (cpp_type(abitype), read_expr(abitype[:-1]))
+    if abitype.endswith('?'):
+        return 'r.fixed<uint8_t>() ? %s(%s) : std::nullopt' % (cpp_type(abitype), read_expr(abitype[:-1]))
+    if abitype.endswith('[]'):
+        return 'r.array<%s>([&]{ return %s; })' % (cpp_type(abitype[:-2]), read_expr(abitype[:-2]))
+    if abitype in FIXED:
+        return 'r.fixed<%s>()' % FIXED[abitype]
+    if abitype in ('string', 'bytes'):
+        return 'r.bytes(r.varuint32())'
+    if abitype == 'checksum256':
+        return 'r.bytes(32)'
+    if abitype == 'varuint32':
+        return 'r.varuint32()'
+    return 'decode_%s(r)' % abitype
+
+def dependencies(struct):
+    deps = []
+    for field in struct['fields']:
+        t = field['type'].rstrip('$?')
+        while t.endswith('[]'):
+            t = t[:-2]
+        deps.append(t)
+    return deps
+
+def main(abipath, outpath):
+    with open(abipath) as f:
+        abi = json.load(f)
+    structs = {s['name']: s for s in abi['structs']}
+
+    ordered = []
+    def visit(name):
+        if name not in structs or name in ordered:
+            return
+        for dep in dependencies(structs[name]):
+            visit(dep)
+        ordered.append(name)
+    for name in sorted(structs):
+        visit(name)
+
+    out = []
+    out.append('// Generated by tools/abi2cpp.py from %s. Do not edit.' % abipath.split('/')[-1])
+    out.append('#pragma once')
+    out.append('')
+    for header in ('cstdint', 'cstring', 'optional', 'stdexcept', 'string_view', 'vector'):
+        out.append('#include <%s>' % header)
+    out.append('')
+    out.append('namespace abirows {')
+    out.append('''
+    struct reader {
+        const char* pos;
+        const char* end;
+
+        bool more() const { return pos < end; }
+
+        void need(size_t n) {
+            if((size_t)(end - pos) < n)
+                throw std::out_of_range("Packed row is too short.");
+        }
+
+        template<typename T>
+        T fixed() {
+            need(sizeof(T));
+            T value;
+            memcpy(&value, pos, sizeof(T));
+            pos += sizeof(T);
+            return value;
+        }
+
+        uint32_t varuint32() {
+            uint32_t value = 0;
+            for(int shift = 0; shift < 35; shift += 7) {
+                uint8_t b = fixed<uint8_t>();
+                value |= (uint32_t)(b & 0x7f) << shift;
+                if((b & 0x80) == 0)
+                    return value;
+            }
+            throw std::out_of_range("Bad varuint32.");
+        }
+
+        std::string_view bytes(size_t n) {
+            need(n);
+            std::string_view value(pos, n);
+            pos += n;
+            return value;
+        }
+
+        template<typename T, typename F>
+        std::vector<T> array(F element) {
+            uint32_t n = varuint32();
+            std::vector<T> values;
+            values.reserve(n < (uint32_t)(end - pos) ? n : (uint32_t)(end - pos));
+            for(uint32_t i = 0; i < n; i++)
+                values.push_back(element());
+            return values;
+        }
+    };
+
+    struct asset {
+        int64_t amount;
+        uint64_t symbol;
+    };
+
+    inline asset decode_asset(reader& r) {
+        asset value;
+        value.amount = r.fixed<int64_t>();
+        value.symbol = r.fixed<uint64_t>();
+        return value;
+    }''')
+    for name in ordered:
+        fields = structs[name]['fields']
+        out.append('')
+        out.append('    struct %s {' % name)
+        for field in fields:
+            out.append('        %s %s;' % (cpp_type(field['type']), field['name']))
+        out.append('    };')
+        out.append('')
+        out.append('    inline %s decode_%s(reader&%s) {' % (name, name, ' r' if fields else ''))
+        out.append('        %s value;' % name)
+        for field in fields:
+            out.append('        value.%s = %s;' % (field['name'], read_expr(field['type'])))
+        out.append('        return value;')
+        out.append('    }')
+
+    out.append('')
+    out.append('    //Decode one packed row of a table. Throws std::out_of_range if the data is too short.')
+    for table in sorted(abi['tables'], key=lambda t: t['name']):
+        out.append('    inline %s decode_%s_row(const char* data, size_t size) {' % (table['type'], table['name']))
+        out.append('        reader r{data, data + size};')
+        out.append('        return decode_%s(r);' % table['type'])
+        out.append('    }')
+    out.append('}')
+
+    with open(outpath, 'w') as f:
+        f.write('\n'.join(out) + '\n')
+
+if __name__ == '__main__':
+    if len(sys.argv) != 3:
+        sys.exit('usage: abi2cpp.py <abi> <header>')
+    main(sys.argv[1], sys.argv[2])
@@ -0,0 +1,82 @@
+#!/usr/bin/env python3
+"""Billed CPU, NET and RAM per action on a local nodeos (see chain.py for starting one).
+
+    tools/bench.py mix.json --repeat 100 --out bench.json
+
+mix.json lists the actions to run in order, repeat times:
+    {"contract": "cptblackbill", "ramaccounts": ["cptblackbill"],
+     "actions": [{"name": "updranking", "auth": "cptblackbill@active", "data": {"pkey": 1, "rankingPoints": 5}}]}
+"{i}" in a string value of data is replaced with the repeat number, so a mix of inserts with --repeat 10000
+seeds a table of realistic size. ram is the change of ram_usage of each ramaccounts account. The report is JSON
+with sorted keys, so reports from two commits can be diffed.
+"""
+import argparse
+import json
+import sys
+
+import chain
+
+
+def fill(value, i):
+    if isinstance(value, str):
+        return value.replace('{i}', str(i))
+    if isinstance(value, dict):
+        return {k: fill(v, i) for k, v in value.items()}
+    if isinstance(value, list):
+        return [fill(v, i) for v in value]
+    return value
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('mix')
+    parser.add_argument('--url', default='http://127.0.0.1:8888')
+    parser.add_argument('--cleos', default='cleos')
+    parser.add_argument('--repeat', type=int, default=1)
+    parser.add_argument('--out', default='-')
+    args = parser.parse_args()
+
+    with open(args.mix) as f:
+        mix = json.load(f)
+    cleos = chain.Cleos(args.url, args.cleos)
+    contract = mix.get('contract', 'cptblackbill')
+    ramaccounts = mix.get('ramaccounts', [contract])
+
+    samples = {}
+    for i in range(args.repeat):
+        for action in mix['actions']:
+            s = samples.setdefault(action['name'], {'cpu': [], 'net': [], 'ram': {a: [] for a in ramaccounts}, 'errors': []})
+            ramBefore = {a: cleos.ram_usage(a) for a in ramaccounts}
+            try:
+                trace = cleos.push(action.get('contract', contract), action['name'], fill(action['data'], i),
+                                   action['auth'], unique=True)
+            except chain.ChainError as e:
+                s['errors'].append(str(e).splitlines()[0] if str(e) else 'error')
+                continue
+            cpu, net = chain.receipt(trace)
+            s['cpu'].append(cpu)
+            s['net'].append(net)
+            for a in ramaccounts:
+                s['ram'][a].append(cleos.ram_usage(a) - ramBefore[a])
+
+    report = {'actions': {}}
+    for name, s in samples.items():
+        report['actions'][name] = {
+            'runs': len(s['cpu']),
+            'errors': len(s['errors']),
+            'firsterror': s['errors'][0] if s['errors'] else None,
+            'cpu_us': chain.summary(s['cpu']),
+            'net_bytes': chain.summary(s['net']),
+            'ram_bytes': {a: chain.summary(v) for a, v in s['ram'].items()},
+        }
+
+    text = json.dumps(report, indent=2, sort_keys=True) + '\n'
+    if args.out == '-':
+        sys.stdout.write(text)
+    else:
+        with open(args.out, 'w') as f:
+            f.write(text)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,73 @@
+"""Helpers for the tools that run actions on a local nodeos through cleos (bench.py, replay.py).
+
+Start a local single-producer chain without network, and deploy a contract built with CMake:
+    nodeos -e -p eosio --plugin eosio::chain_api_plugin --plugin eosio::producer_plugin \\
+        --p2p-max-nodes-per-host 0 --data-dir /tmp/nodeos --config-dir /tmp/nodeos --delete-all-blocks
+    cleos set contract cptblackbill build/production cptblackbill.wasm cptblackbill.abi
+The accounts used by the actions must exist and their keys must be in the unlocked cleos wallet.
+"""
+import json
+import subprocess
+
+
+class ChainError(Exception):
+    pass
+
+
+class Cleos:
+    def __init__(self, url, cleos='cleos'):
+        self.url = url
+        self.cleos = cleos
+
+    def run(self, *args):
+        result = subprocess.run([self.cleos, '-u', self.url] + list(args), capture_output=True, text=True)
+        if result.returncode != 0:
+            raise ChainError(result.stderr.strip() or result.stdout.strip())
+        return result.stdout
+
+    def push(self, contract, action, data, auth, unique=False):
+        """Push one action and return the transaction trace"""
+        args = ['push', 'action', contract, action, json.dumps(data), '-p', auth, '-j']
+        if unique:
+            args.append('-f') #Same action and data more than once in a block
+        return json.loads(self.run(*args))
+
+    def ram_usage(self, account):
+        return json.loads(self.run('get', 'account', account, '-j'))['ram_usage']
+
+
+def receipt(trace):
+    """Billed CPU in microseconds and NET in bytes of a transaction trace"""
+    r = trace['processed']['receipt']
+    return r['cpu_usage_us'], r['net_usage_words'] * 8
+
+
+def console(trace):
+    return ''.join(t.get('console', '') for t in trace['processed']['action_traces'])
+
+
+def name_to_uint64(s):
+    """eosio::name value of s, for uint64 scope arguments"""
+    charmap = '.12345abcdefghijklmnopqrstuvwxyz'
+    value = 0
+    for i in range(13):
+        c = charmap.index(s[i]) if i < len(s) else 0
+        if i < 12:
+            value |= (c & 0x1f) << (64 - 5 * (i + 1))
+        else:
+            value |= c & 0x0f
+    return value
+
+
+def percentile(values, p):
+    """Nearest-rank percentile, p in 0..100"""
+    if not values:
+        return None
+    ordered = sorted(values)
+    rank = max(1, -(-len(ordered) * p // 100))
+    return ordered[int(rank) - 1]
+
+
+def summary(values):
+    return {'min': min(values), 'p50': percentile(values, 50), 'p90': percentile(values, 90),
+            'p99': percentile(values, 99), 'max': max(values)} if values else None
@@ -0,0 +1,110 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ *
+ *  In-memory mirror of the treasure table for an off-chain query service. Feed it the table deltas of the
+ *  contract (packed rows from a state-history endpoint, or get_table_rows with "json": false): upsert for a
+ *  new or changed row, erase for a removed row. Queries by owner, map tile and creation time read indexes
+ *  instead of paging get_table_rows.
+ */
+#pragma once
+
+#include <map>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cptblackbill_rows.hpp"
+#include "maptile.hpp"
+
+namespace indexer {
+
+    class treasure_mirror {
+    public:
+        //Add or replace the row. The packed data is kept, the decoded strings point into it.
+        void upsert(std::string packed) {
+            auto e = std::make_unique<entry>();
+            e->data = std::move(packed);
+            e->row = abirows::decode_treasure_row(e->data.data(), e->data.size());
+            uint64_t pkey = e->row.pkey;
+            erase(pkey);
+            add_keys(*e);
+            rows[pkey] = std::move(e);
+        }
+
+        void erase(uint64_t pkey) {
+            auto itr = rows.find(pkey);
+            if(itr == rows.end())
+                return;
+            const abirows::treasure& t = itr->second->row;
+            erase_key(owners, t.owner, pkey);
+            erase_key(tiles, landkey(t), pkey);
+            erase_key(created, (int64_t)t.timestamp, pkey);
+            rows.erase(itr);
+        }
+
+        const abirows::treasure* find(uint64_t pkey) const {
+            auto itr = rows.find(pkey);
+            return itr == rows.end() ? nullptr : &itr->second->row;
+        }
+
+        size_t size() const { return rows.size(); }
+
+        std::vector<uint64_t> by_owner(uint64_t owner) const {
+            return collect(owners.equal_range(owner));
+        }
+
+        //Checkpoints on a map tile of zoom level zoom (maptile::tilekey). The zoom 17 keys of a tile are one range.
+        std::vector<uint64_t> in_tile(uint64_t tileKey, int zoom) const {
+            int shift = 2 * (maptile::landZoom - zoom);
+            return collect(std::make_pair(tiles.lower_bound(tileKey << shift), tiles.lower_bound((tileKey + 1) << shift)));
+        }
+
+        //Checkpoints created from fromTimestamp up to, not including, toTimestamp
+        std::vector<uint64_t> created_between(int32_t fromTimestamp, int32_t toTimestamp) const {
+            return collect(std::make_pair(created.lower_bound(fromTimestamp), created.lower_bound(toTimestamp)));
+        }
+
+    private:
+        struct entry {
+            std::string data;
+            abirows::treasure row;
+        };
+
+        //entry is allocated once so the string_views in row stay valid when the map rebalances
+        std::map<uint64_t, std::unique_ptr<entry>> rows;
+        std::multimap<uint64_t, uint64_t> owners;
+        std::multimap<uint64_t, uint64_t> tiles; //Zoom 17 tile key
+        std::multimap<int64_t, uint64_t> created;
+
+        static uint64_t landkey(const abirows::treasure& t) {
+            return maptile::tilekey(t.latitude, t.longitude, maptile::landZoom);
+        }
+
+        void add_keys(const entry& e) {
+            owners.emplace(e.row.owner, e.row.pkey);
+            tiles.emplace(landkey(e.row), e.row.pkey);
+            created.emplace(e.row.timestamp, e.row.pkey);
+        }
+
+        template<typename Index, typename Key>
+        static void erase_key(Index& index, Key key, uint64_t pkey) {
+            auto range = index.equal_range(key);
+            for(auto itr = range.first; itr != range.second; itr++) {
+                if(itr->second == pkey){
+                    index.erase(itr);
+                    return;
+                }
+            }
+        }
+
+        template<typename Itr>
+        static std::vector<uint64_t> collect(std::pair<Itr, Itr> range) {
+            std::vector<uint64_t> pkeys;
+            for(auto itr = range.first; itr != range.second; itr++)
+                pkeys.push_back(itr->second);
+            return pkeys;
+        }
+    };
+}
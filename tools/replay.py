@@ -0,0 +1,129 @@
+#!/usr/bin/env python3
+"""Replay recorded actions on a local nodeos and hash the contract tables at checkpoints.
+
+    tools/replay.py actions.jsonl --checkpoint 1000 --tables treasure,holdings@alice,results@202610 --out run.json
+    tools/replay.py actions.jsonl ... --out new.json --compare run.json
+
+actions.jsonl has one action per line, as in a block or history API export:
+    {"account": "cptblackbill", "name": "addlike", "authorization": [{"actor": "alice", "permission": "active"}],
+     "data": {...}}
+eosio.token transfers to the contract are replayed as transfers, so the contract gets the same notifications.
+The contract must be the diagnostics build (statehash). Tables are table@scope, the scope is the contract
+account if left out and can be a name or a number. The hashes are taken with statehash after every checkpoint
+actions and at the end. --compare exits with 1 if a hash differs from an earlier run.
+Rows that store now() (timestamp fields) differ between two replays unless the block times are the same, so
+compare tables or runs where that holds.
+"""
+import argparse
+import json
+import sys
+import time
+
+import chain
+
+
+def read_actions(path):
+    with open(path) as f:
+        for line in f:
+            line = line.strip()
+            if line:
+                yield json.loads(line)
+
+
+def table_hash(cleos, contract, auth, table, scope, maxrows):
+    """Hash of table@scope, paged through statehash"""
+    prev = '00' * 32
+    cursor = 0
+    rows = 0
+    while True:
+        trace = cleos.push(contract, 'statehash', {'table': table, 'scope': scope, 'cursor': cursor,
+                                                    'maxrows': maxrows, 'prev': prev}, auth, unique=True)
+        page = json.loads(chain.console(trace))
+        prev = page['hash']
+        rows += page['rows']
+        if not page['more']:
+            return {'hash': prev, 'rows': rows}
+        cursor = page['cursor']
+
+
+def hash_tables(cleos, args, tables):
+    hashes = {}
+    for item in tables:
+        table, _, scope = item.partition('@')
+        scope = scope or args.contract
+        scopeValue = int(scope) if scope.isdigit() else chain.name_to_uint64(scope)
+        hashes[table + '@' + scope] = table_hash(cleos, args.contract, args.hash_auth, table, scopeValue, args.maxrows)
+    return hashes
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument('actions')
+    parser.add_argument('--url', default='http://127.0.0.1:8888')
+    parser.add_argument('--cleos', default='cleos')
+    parser.add_argument('--contract', default='cptblackbill')
+    parser.add_argument('--hash-auth', default='cptblackbill@active', help='Authorization for the statehash actions')
+    parser.add_argument('--tables', default='treasure', help='Comma separated table@scope list to hash')
+    parser.add_argument('--checkpoint', type=int, default=0, help='Hash the tables after every N actions')
+    parser.add_argument('--maxrows', type=int, default=500, help='Rows per statehash call')
+    parser.add_argument('--out', default='-')
+    parser.add_argument('--compare', help='Report of an earlier run to compare the hashes with')
+    args = parser.parse_args()
+
+    cleos = chain.Cleos(args.url, args.cleos)
+    tables = [t for t in args.tables.split(',') if t]
+    latencies = []
+    cpu = {}
+    failed = {}
+    checkpoints = []
+    count = 0
+    replayTime = 0.0
+
+    for action in read_actions(args.actions):
+        auth = ','.join(a['actor'] + '@' + a['permission'] for a in action['authorization'])
+        started = time.perf_counter()
+        try:
+            trace = cleos.push(action['account'], action['name'], action['data'], auth, unique=True)
+            cpu.setdefault(action['name'], []).append(chain.receipt(trace)[0])
+        except chain.ChainError:
+            failed[action['name']] = failed.get(action['name'], 0) + 1 #Failed on the recorded chain too, or a difference
+        elapsed = time.perf_counter() - started
+        replayTime += elapsed
+        latencies.append(elapsed * 1000)
+        count += 1
+        if args.checkpoint > 0 and count % args.checkpoint == 0:
+            checkpoints.append({'after': count, 'hashes': hash_tables(cleos, args, tables)})
+
+    if not checkpoints or checkpoints[-1]['after'] != count:
+        checkpoints.append({'after': count, 'hashes': hash_tables(cleos, args, tables)})
+
+    report = {
+        'actions': count,
+        'actions_per_second': round(count / replayTime, 1) if replayTime > 0 else None,
+        'latency_ms': {k: round(v, 3) for k, v in chain.summary(latencies).items()} if latencies else None,
+        'cpu_us': {name: chain.summary(v) for name, v in cpu.items()},
+        'failed': failed,
+        'checkpoints': checkpoints,
+    }
+    text = json.dumps(report, indent=2, sort_keys=True) + '\n'
+    if args.out == '-':
+        sys.stdout.write(text)
+    else:
+        with open(args.out, 'w') as f:
+            f.write(text)
+
+    if args.compare:
+        with open(args.compare) as f:
+            earlier = {c['after']: c['hashes'] for c in json.load(f)['checkpoints']}
+        differences = 0
+        for c in checkpoints:
+            for key, value in c['hashes'].items():
+                other = earlier.get(c['after'], {}).get(key)
+                if other is not None and other != value:
+                    print('after %d actions %s differs: %s' % (c['after'], key, value['hash']), file=sys.stderr)
+                    differences += 1
+        sys.exit(1 if differences else 0)
+
+
+if __name__ == '__main__':
+    main()